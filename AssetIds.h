@@ -0,0 +1,61 @@
+#pragma once
+
+// Every file the game loads. The sprite entries come first and follow the
+// SpriteId order, so a SpriteId converts to its AssetId with a cast.
+// tools/AssetPacker refuses to build a pack if any of these is missing or
+// its name differs in case from the file on disk.
+enum class AssetId {
+    SPRITE_BACKGROUND,
+    SPRITE_RAIL_LEFT,
+    SPRITE_RAIL_MID,
+    SPRITE_RAIL_RIGHT,
+    SPRITE_CART,
+    SPRITE_DIAMOND,
+    SPRITE_RUBY,
+    SPRITE_AMETHYST,
+    SPRITE_GOLDBAR,
+    SPRITE_SILVERBAR,
+    SPRITE_DYNAMITE,
+    FONT_PIXELATED,
+    SOUND_COLLECT,
+    SOUND_EXPLODE,
+    MUSIC_BGM,
+    COUNT
+};
+
+enum class AssetKind {
+    IMAGE,
+    FONT,
+    SOUND,
+    MUSIC
+};
+
+struct AssetInfo {
+    const char* fileName;
+    AssetKind kind;
+};
+
+static const int SPRITE_ASSET_COUNT = 11;
+static const int ASSET_COUNT = static_cast<int>(AssetId::COUNT);
+
+static const AssetInfo ASSET_INFO[ASSET_COUNT] = {
+    { "Resources/BG.png", AssetKind::IMAGE },
+    { "Resources/RailLeft.png", AssetKind::IMAGE },
+    { "Resources/RailMid.png", AssetKind::IMAGE },
+    { "Resources/RailRight.png", AssetKind::IMAGE },
+    { "Resources/Cart.png", AssetKind::IMAGE },
+    { "Resources/Diamond.png", AssetKind::IMAGE },
+    { "Resources/Ruby.png", AssetKind::IMAGE },
+    { "Resources/Amethyst.png", AssetKind::IMAGE },
+    { "Resources/Gold.png", AssetKind::IMAGE },
+    { "Resources/Silver.png", AssetKind::IMAGE },
+    { "Resources/Dynamite.png", AssetKind::IMAGE },
+    { "Resources/Pixelated.ttf", AssetKind::FONT },
+    { "Resources/collect.mp3", AssetKind::SOUND },
+    { "Resources/explode.mp3", AssetKind::SOUND },
+    { "Resources/bgm.mp3", AssetKind::MUSIC },
+};
+
+inline const AssetInfo& getAssetInfo(AssetId id) {
+    return ASSET_INFO[static_cast<int>(id)];
+}
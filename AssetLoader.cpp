@@ -0,0 +1,95 @@
+#include "AssetLoader.h"
+#include <chrono>
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+AssetLoader::AssetLoader() :
+    nextJob(0),
+    uploadedCount(0)
+{
+}
+
+AssetLoader::~AssetLoader() {
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void AssetLoader::add(const char* name, std::function<void()> decode, std::function<void()> upload) {
+    jobs.push_back(Job{ AssetTiming{ name, 0.0, 0.0 }, decode, upload });
+}
+
+void AssetLoader::start(int workerCount) {
+    if (workerCount < 1) {
+        workerCount = 1;
+    }
+    decoded.reserve(jobs.size());
+    uploading.reserve(jobs.size());
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+}
+
+// Workers pull jobs in order until none are left, then exit.
+void AssetLoader::workerLoop() {
+    for (;;) {
+        size_t index = nextJob.fetch_add(1);
+        if (index >= jobs.size()) {
+            return;
+        }
+        Job& job = jobs[index];
+        auto start = std::chrono::steady_clock::now();
+        if (job.decode) {
+            job.decode();
+        }
+        job.timing.decodeMs = millisecondsSince(start);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded.push_back(index);
+        decodedSignal.notify_one();
+    }
+}
+
+void AssetLoader::uploadDecoded() {
+    for (size_t index : uploading) {
+        Job& job = jobs[index];
+        auto start = std::chrono::steady_clock::now();
+        if (job.upload) {
+            job.upload();
+        }
+        job.timing.uploadMs = millisecondsSince(start);
+        uploadedCount++;
+    }
+    uploading.clear();
+}
+
+void AssetLoader::pump() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uploading.swap(decoded);
+    }
+    uploadDecoded();
+}
+
+void AssetLoader::wait() {
+    while (!isDone()) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            decodedSignal.wait(lock, [this] { return !decoded.empty(); });
+            uploading.swap(decoded);
+        }
+        uploadDecoded();
+    }
+}
+
+float AssetLoader::getProgress() const {
+    return jobs.empty() ? 1.0f : (float)uploadedCount / (float)jobs.size();
+}
+
+void AssetLoader::forEachTiming(const std::function<void(const AssetTiming&)>& visit) const {
+    for (const Job& job : jobs) {
+        visit(job.timing);
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct AssetTiming {
+    const char* name;
+    double decodeMs;
+    double uploadMs;
+};
+
+// Loads assets in two steps. decode() runs on a worker thread and must only
+// touch CPU memory (file reads, PNG/TTF/MP3 decoding). upload() runs on the
+// main thread once its decode has finished and does whatever needs the GPU
+// or the audio device. Call pump() every frame until isDone().
+class AssetLoader {
+private:
+    struct Job {
+        AssetTiming timing;
+        std::function<void()> decode;
+        std::function<void()> upload;
+    };
+
+    std::vector<Job> jobs;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextJob;
+    std::mutex mutex;
+    std::condition_variable decodedSignal;
+    std::vector<size_t> decoded;
+    std::vector<size_t> uploading;
+    size_t uploadedCount;
+
+    void workerLoop();
+    void uploadDecoded();
+
+public:
+    AssetLoader();
+    ~AssetLoader();
+
+    // Jobs may only be added before start().
+    void add(const char* name, std::function<void()> decode, std::function<void()> upload);
+    void start(int workerCount);
+
+    void pump();
+    void wait();
+    bool isDone() const { return uploadedCount == jobs.size(); }
+    float getProgress() const;
+
+    void forEachTiming(const std::function<void(const AssetTiming&)>& visit) const;
+};
@@ -0,0 +1,135 @@
+#include "AssetPack.h"
+#include <cstring>
+
+const char* const AssetPack::MAGIC = "CDGP";
+const char* const AssetPack::DEFAULT_PATH = "Resources/assets.pack";
+
+AssetPack::AssetPack() :
+    entries(nullptr)
+{
+}
+
+bool AssetPack::open(const char* path) {
+    close();
+    if (!file.open(path)) {
+        return false;
+    }
+    if (!validate(path)) {
+        file.close();
+        return false;
+    }
+    entries = reinterpret_cast<const PackEntry*>(file.getData() + sizeof(PackHeader));
+    return true;
+}
+
+// A pack that does not match this build's asset table is rejected as a whole
+// so the game falls back to the loose files instead of reading garbage.
+bool AssetPack::validate(const char* path) const {
+    const unsigned char* data = file.getData();
+    size_t tableEnd = sizeof(PackHeader) + sizeof(PackEntry) * ASSET_COUNT;
+    if (file.getSize() < tableEnd) {
+        TraceLog(LOG_WARNING, "PACK: [%s] is truncated", path);
+        return false;
+    }
+    const PackHeader* header = reinterpret_cast<const PackHeader*>(data);
+    if (memcmp(header->magic, MAGIC, 4) != 0 || header->version != VERSION ||
+        header->entryCount != (uint32_t)ASSET_COUNT) {
+        TraceLog(LOG_WARNING, "PACK: [%s] was built for a different asset table", path);
+        return false;
+    }
+
+    const PackEntry* table = reinterpret_cast<const PackEntry*>(data + sizeof(PackHeader));
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        const PackEntry& entry = table[i];
+        if (entry.kind != (uint32_t)ASSET_INFO[i].kind ||
+            entry.offset < tableEnd || entry.offset % PACK_ALIGNMENT != 0 ||
+            entry.offset > file.getSize() || entry.size > file.getSize() - entry.offset) {
+            TraceLog(LOG_WARNING, "PACK: [%s] has a bad entry for %s", path, ASSET_INFO[i].fileName);
+            return false;
+        }
+        uint64_t expected = 0;
+        switch (ASSET_INFO[i].kind) {
+        case AssetKind::IMAGE:
+            expected = (uint64_t)GetPixelDataSize(entry.params[0], entry.params[1], entry.params[2]);
+            break;
+        case AssetKind::FONT:
+            expected = (uint64_t)entry.params[1] * sizeof(PackGlyph) +
+                (uint64_t)GetPixelDataSize(entry.params[3], entry.params[4], entry.params[5]);
+            break;
+        case AssetKind::SOUND:
+            expected = (uint64_t)entry.params[0] * entry.params[3] * (entry.params[2] / 8);
+            break;
+        case AssetKind::MUSIC:
+            expected = entry.size;
+            break;
+        }
+        if (entry.size != expected) {
+            TraceLog(LOG_WARNING, "PACK: [%s] has a bad entry for %s", path, ASSET_INFO[i].fileName);
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetPack::close() {
+    file.close();
+    entries = nullptr;
+}
+
+Image AssetPack::getImage(AssetId id) const {
+    const PackEntry& entry = entries[static_cast<int>(id)];
+    Image image = {};
+    image.data = const_cast<unsigned char*>(file.getData() + entry.offset);
+    image.width = (int)entry.params[0];
+    image.height = (int)entry.params[1];
+    image.mipmaps = 1;
+    image.format = (int)entry.params[2];
+    return image;
+}
+
+Wave AssetPack::getWave(AssetId id) const {
+    const PackEntry& entry = entries[static_cast<int>(id)];
+    Wave wave = {};
+    wave.frameCount = entry.params[0];
+    wave.sampleRate = entry.params[1];
+    wave.sampleSize = entry.params[2];
+    wave.channels = entry.params[3];
+    wave.data = const_cast<unsigned char*>(file.getData() + entry.offset);
+    return wave;
+}
+
+const unsigned char* AssetPack::getBytes(AssetId id, int* size) const {
+    const PackEntry& entry = entries[static_cast<int>(id)];
+    *size = (int)entry.size;
+    return file.getData() + entry.offset;
+}
+
+Font AssetPack::loadFont(AssetId id, Image* atlas) const {
+    const PackEntry& entry = entries[static_cast<int>(id)];
+    const unsigned char* data = file.getData() + entry.offset;
+    const PackGlyph* packed = reinterpret_cast<const PackGlyph*>(data);
+
+    Font font = {};
+    font.baseSize = (int)entry.params[0];
+    font.glyphCount = (int)entry.params[1];
+    font.glyphPadding = (int)entry.params[2];
+    font.glyphs = (GlyphInfo*)MemAlloc(font.glyphCount * sizeof(GlyphInfo));
+    font.recs = (Rectangle*)MemAlloc(font.glyphCount * sizeof(Rectangle));
+    // Glyph images are only used by ImageDrawText, which the game never calls
+    for (int i = 0; i < font.glyphCount; i++) {
+        font.glyphs[i].value = packed[i].value;
+        font.glyphs[i].offsetX = packed[i].offsetX;
+        font.glyphs[i].offsetY = packed[i].offsetY;
+        font.glyphs[i].advanceX = packed[i].advanceX;
+        font.glyphs[i].image = Image{};
+        font.recs[i] = Rectangle{ packed[i].x, packed[i].y, packed[i].width, packed[i].height };
+    }
+
+    *atlas = Image{};
+    atlas->data = const_cast<unsigned char*>(data + font.glyphCount * sizeof(PackGlyph));
+    atlas->width = (int)entry.params[3];
+    atlas->height = (int)entry.params[4];
+    atlas->mipmaps = 1;
+    atlas->format = (int)entry.params[5];
+    return font;
+}
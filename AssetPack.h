@@ -0,0 +1,72 @@
+#pragma once
+#include "raylib.h"
+#include "AssetIds.h"
+#include "MappedFile.h"
+#include <cstdint>
+
+// Pack layout, little endian, built by tools/AssetPacker:
+//   PackHeader
+//   PackEntry[ASSET_COUNT], indexed by AssetId
+//   data blocks, each aligned to PACK_ALIGNMENT
+// Images are stored as raw pixels, the font as its glyph table followed by
+// the rasterized glyph atlas, sounds as PCM and the music as the original
+// MP3 since it is streamed anyway.
+static const uint32_t PACK_ALIGNMENT = 16;
+
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+// params by kind:
+//   IMAGE: width, height, pixel format
+//   FONT:  base size, glyph count, glyph padding, atlas width, atlas height, atlas pixel format
+//   SOUND: frame count, sample rate, sample size, channels
+struct PackEntry {
+    uint32_t kind;
+    uint32_t params[6];
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct PackGlyph {
+    int32_t value;
+    int32_t offsetX;
+    int32_t offsetY;
+    int32_t advanceX;
+    float x;
+    float y;
+    float width;
+    float height;
+};
+
+// Read side of the pack. Images, waves and bytes returned here point into the
+// mapping: they stay valid until close() and must not be unloaded.
+class AssetPack {
+private:
+    MappedFile file;
+    const PackEntry* entries;
+
+    bool validate(const char* path) const;
+
+public:
+    static const uint32_t VERSION = 1;
+    static const char* const MAGIC;
+    static const char* const DEFAULT_PATH;
+
+    AssetPack();
+
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return entries != nullptr; }
+
+    Image getImage(AssetId id) const;
+    Wave getWave(AssetId id) const;
+    const unsigned char* getBytes(AssetId id, int* size) const;
+    // The glyph table is copied into raylib-owned memory so UnloadFont()
+    // works as usual; atlas is set to a view of the packed glyph atlas.
+    Font loadFont(AssetId id, Image* atlas) const;
+};
@@ -0,0 +1,90 @@
+#include "AudioDevice.h"
+
+void RaylibAudioDevice::open() {
+    InitAudioDevice();
+}
+
+void RaylibAudioDevice::close() {
+    CloseAudioDevice();
+}
+
+Sound RaylibAudioDevice::loadSound(const char* fileName) {
+    return LoadSound(fileName);
+}
+
+Wave RaylibAudioDevice::loadWave(const char* fileName) {
+    return LoadWave(fileName);
+}
+
+Sound RaylibAudioDevice::loadSoundFromWave(Wave wave) {
+    return LoadSoundFromWave(wave);
+}
+
+void RaylibAudioDevice::unloadWave(Wave wave) {
+    UnloadWave(wave);
+}
+
+void RaylibAudioDevice::unloadSound(Sound sound) {
+    UnloadSound(sound);
+}
+
+// raylib dereferences the source's buffer, which a failed load leaves null
+Sound RaylibAudioDevice::loadSoundAlias(Sound source) {
+    return source.stream.buffer != nullptr ? LoadSoundAlias(source) : Sound{};
+}
+
+void RaylibAudioDevice::unloadSoundAlias(Sound alias) {
+    UnloadSoundAlias(alias);
+}
+
+void RaylibAudioDevice::playSound(Sound sound) {
+    PlaySound(sound);
+}
+
+void RaylibAudioDevice::stopSound(Sound sound) {
+    StopSound(sound);
+}
+
+bool RaylibAudioDevice::isSoundPlaying(Sound sound) {
+    return IsSoundPlaying(sound);
+}
+
+Music RaylibAudioDevice::loadMusic(const char* fileName) {
+    return LoadMusicStream(fileName);
+}
+
+Music RaylibAudioDevice::loadMusicFromMemory(const char* fileType, const unsigned char* data, int size) {
+    return LoadMusicStreamFromMemory(fileType, data, size);
+}
+
+void RaylibAudioDevice::unloadMusic(Music music) {
+    UnloadMusicStream(music);
+}
+
+void RaylibAudioDevice::playMusic(Music music) {
+    PlayMusicStream(music);
+}
+
+void RaylibAudioDevice::stopMusic(Music music) {
+    StopMusicStream(music);
+}
+
+void RaylibAudioDevice::pauseMusic(Music music) {
+    PauseMusicStream(music);
+}
+
+void RaylibAudioDevice::resumeMusic(Music music) {
+    ResumeMusicStream(music);
+}
+
+void RaylibAudioDevice::updateMusic(Music music) {
+    UpdateMusicStream(music);
+}
+
+bool RaylibAudioDevice::isMusicPlaying(Music music) {
+    return IsMusicStreamPlaying(music);
+}
+
+void RaylibAudioDevice::setMusicVolume(Music music, float volume) {
+    SetMusicVolume(music, volume);
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "raylib.h"
+
+// Sound effects and streamed music. NullAudioDevice never opens a device.
+class AudioDevice {
+public:
+    virtual ~AudioDevice() {}
+
+    virtual void open() = 0;
+    virtual void close() = 0;
+
+    virtual Sound loadSound(const char* fileName) = 0;
+    // loadWave decodes into memory and may run on a worker thread;
+    // loadSoundFromWave needs the device and must run on the main thread.
+    virtual Wave loadWave(const char* fileName) = 0;
+    virtual Sound loadSoundFromWave(Wave wave) = 0;
+    virtual void unloadWave(Wave wave) = 0;
+    virtual void unloadSound(Sound sound) = 0;
+    // An alias shares the source's samples but plays as its own voice. It
+    // must be unloaded before the source.
+    virtual Sound loadSoundAlias(Sound source) = 0;
+    virtual void unloadSoundAlias(Sound alias) = 0;
+    virtual void playSound(Sound sound) = 0;
+    virtual void stopSound(Sound sound) = 0;
+    virtual bool isSoundPlaying(Sound sound) = 0;
+
+    virtual Music loadMusic(const char* fileName) = 0;
+    // The data must stay alive until the music is unloaded.
+    virtual Music loadMusicFromMemory(const char* fileType, const unsigned char* data, int size) = 0;
+    virtual void unloadMusic(Music music) = 0;
+    virtual void playMusic(Music music) = 0;
+    virtual void stopMusic(Music music) = 0;
+    virtual void pauseMusic(Music music) = 0;
+    virtual void resumeMusic(Music music) = 0;
+    virtual void updateMusic(Music music) = 0;
+    virtual bool isMusicPlaying(Music music) = 0;
+    virtual void setMusicVolume(Music music, float volume) = 0;
+};
+
+class RaylibAudioDevice : public AudioDevice {
+public:
+    void open() override;
+    void close() override;
+
+    Sound loadSound(const char* fileName) override;
+    Wave loadWave(const char* fileName) override;
+    Sound loadSoundFromWave(Wave wave) override;
+    void unloadWave(Wave wave) override;
+    void unloadSound(Sound sound) override;
+    Sound loadSoundAlias(Sound source) override;
+    void unloadSoundAlias(Sound alias) override;
+    void playSound(Sound sound) override;
+    void stopSound(Sound sound) override;
+    bool isSoundPlaying(Sound sound) override;
+
+    Music loadMusic(const char* fileName) override;
+    Music loadMusicFromMemory(const char* fileType, const unsigned char* data, int size) override;
+    void unloadMusic(Music music) override;
+    void playMusic(Music music) override;
+    void stopMusic(Music music) override;
+    void pauseMusic(Music music) override;
+    void resumeMusic(Music music) override;
+    void updateMusic(Music music) override;
+    bool isMusicPlaying(Music music) override;
+    void setMusicVolume(Music music, float volume) override;
+};
+
+class NullAudioDevice : public AudioDevice {
+private:
+    bool musicPlaying;
+
+public:
+    NullAudioDevice() : musicPlaying(false) {}
+
+    void open() override {}
+    void close() override {}
+
+    Sound loadSound(const char* fileName) override { return Sound{}; }
+    Wave loadWave(const char* fileName) override { return Wave{}; }
+    Sound loadSoundFromWave(Wave wave) override { return Sound{}; }
+    void unloadWave(Wave wave) override {}
+    void unloadSound(Sound sound) override {}
+    Sound loadSoundAlias(Sound source) override { return source; }
+    void unloadSoundAlias(Sound alias) override {}
+    void playSound(Sound sound) override {}
+    void stopSound(Sound sound) override {}
+    bool isSoundPlaying(Sound sound) override { return false; }
+
+    Music loadMusic(const char* fileName) override { return Music{}; }
+    Music loadMusicFromMemory(const char* fileType, const unsigned char* data, int size) override { return Music{}; }
+    void unloadMusic(Music music) override {}
+    void playMusic(Music music) override { musicPlaying = true; }
+    void stopMusic(Music music) override { musicPlaying = false; }
+    void pauseMusic(Music music) override {}
+    void resumeMusic(Music music) override {}
+    void updateMusic(Music music) override {}
+    bool isMusicPlaying(Music music) override { return musicPlaying; }
+    void setMusicVolume(Music music, float volume) override {}
+};
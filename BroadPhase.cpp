@@ -0,0 +1,36 @@
+#include "BroadPhase.h"
+
+// Room for rounding in the exact test, which works from the object's top
+// edge rather than its centre
+static const float BAND_MARGIN = 1.0f;
+
+BroadPhase::BroadPhase() :
+    box(),
+    bandTop(0.0f),
+    bandBottom(-1.0f),
+    stats()
+{
+}
+
+// Objects are culled by their centre, so the band is grown by half the
+// largest object size to keep every possible overlap.
+void BroadPhase::begin(Rectangle area, float maxObjectSize) {
+    float halfSize = maxObjectSize / 2 + BAND_MARGIN;
+    box = area;
+    bandTop = area.y - halfSize;
+    bandBottom = area.y + area.height + halfSize;
+}
+
+size_t BroadPhase::collide(const MotionKernels& kernels, const MotionArrays& motion, size_t begin, size_t end,
+    uint32_t* hits, size_t& candidates) const {
+    candidates = kernels.cull(motion, begin, end, bandTop, bandBottom, hits);
+    return collideCandidates(motion, hits, candidates, box, hits);
+}
+
+void BroadPhase::record(size_t tested, size_t candidates) {
+    stats.tested = tested;
+    stats.candidates = candidates;
+    stats.rejected = tested - candidates;
+    stats.totalCandidates += stats.candidates;
+    stats.totalRejected += stats.rejected;
+}
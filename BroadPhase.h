@@ -0,0 +1,40 @@
+#pragma once
+#include "raylib.h"
+#include "MotionKernels.h"
+#include <cstddef>
+#include <cstdint>
+
+struct BroadPhaseStats {
+    size_t tested;
+    size_t candidates;
+    size_t rejected;
+    unsigned long long totalCandidates;
+    unsigned long long totalRejected;
+};
+
+// Culls objects before the exact AABB test against a single query box (the
+// cart). The box sits on the rail row, so the cull kernel first keeps only
+// active objects whose centre is in the vertical band the box can reach, and
+// the exact test runs on those few. Hits come back in ascending index order,
+// exactly as the collide kernel would return them over the whole range.
+class BroadPhase {
+private:
+    Rectangle box;
+    float bandTop;
+    float bandBottom;
+    BroadPhaseStats stats;
+
+public:
+    BroadPhase();
+
+    // Starts a tick. maxObjectSize must cover every object in the pool.
+    void begin(Rectangle area, float maxObjectSize);
+    // Culls [begin, end) and tests what is left, writing the hits over the
+    // candidates. Chunks may call this at once on ranges that do not overlap.
+    size_t collide(const MotionKernels& kernels, const MotionArrays& motion, size_t begin, size_t end,
+        uint32_t* hits, size_t& candidates) const;
+    // Adds a tick's counts, once every chunk has finished
+    void record(size_t tested, size_t candidates);
+
+    const BroadPhaseStats& getStats() const { return stats; }
+};
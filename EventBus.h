@@ -0,0 +1,294 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Events of one type handed to a subscriber in a single call, in the order
+// they were published.
+template <typename E>
+struct EventBatch {
+    const E* events;
+    size_t count;
+
+    const E* begin() const { return events; }
+    const E* end() const { return events + count; }
+    const E& operator[](size_t index) const { return events[index]; }
+    const E& back() const { return events[count - 1]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+// Specialize to fold an event into the one queued just before it. Returning
+// true drops the new event.
+template <typename E>
+struct EventTraits {
+    static bool coalesce(E& previous, const E& next) { return false; }
+};
+
+class EventChannelBase {
+public:
+    virtual ~EventChannelBase() {}
+    virtual void unsubscribe(uint32_t id) = 0;
+    virtual void dispatch() = 0;
+    virtual void clear() = 0;
+};
+
+// Unsubscribes when destroyed. The channel is only held weakly, so a
+// subscription may outlive the bus it came from.
+class Subscription {
+private:
+    std::weak_ptr<EventChannelBase> channel;
+    uint32_t id;
+
+public:
+    Subscription();
+    Subscription(std::weak_ptr<EventChannelBase> eventChannel, uint32_t subscriberId);
+    Subscription(Subscription&& other) noexcept;
+    Subscription& operator=(Subscription&& other) noexcept;
+    Subscription(const Subscription&) = delete;
+    Subscription& operator=(const Subscription&) = delete;
+    ~Subscription();
+
+    void reset();
+    bool isActive() const { return id != 0 && !channel.expired(); }
+};
+
+// Queues one event type. Events published while a batch is being delivered
+// go out with the next dispatch, and handlers added or removed mid-dispatch
+// take effect once it finishes.
+template <typename E>
+class EventChannel : public EventChannelBase {
+private:
+    struct Handler {
+        uint32_t id;
+        std::function<void(const EventBatch<E>&)> callback;
+    };
+
+    std::vector<E> pending;
+    std::vector<E> delivering;
+    std::vector<Handler> handlers;
+    std::vector<Handler> added;
+    uint32_t nextId;
+    bool dispatching;
+    bool removedDuringDispatch;
+
+public:
+    EventChannel();
+
+    uint32_t subscribe(std::function<void(const EventBatch<E>&)> callback);
+    void unsubscribe(uint32_t id) override;
+    void publish(const E& event);
+    void dispatch() override;
+    void clear() override;
+
+    size_t getPendingCount() const { return pending.size(); }
+    size_t getSubscriberCount() const { return handlers.size() + added.size(); }
+};
+
+// Simulation code publishes into the bus during a tick; GameManager
+// dispatches everything once per frame. Channels are created on first use,
+// one per event type.
+class EventBus {
+private:
+    std::vector<std::shared_ptr<EventChannelBase>> channels;
+
+    static size_t nextTypeIndex() {
+        static size_t count = 0;
+        return count++;
+    }
+
+    template <typename E>
+    static size_t typeIndex() {
+        static const size_t index = nextTypeIndex();
+        return index;
+    }
+
+    template <typename E>
+    EventChannel<E>& channel();
+
+public:
+    template <typename E>
+    Subscription subscribe(std::function<void(const EventBatch<E>&)> callback);
+
+    template <typename E>
+    void publish(const E& event) { channel<E>().publish(event); }
+
+    // Delivers every queued event, one channel at a time
+    void dispatch();
+    void clear();
+};
+
+inline Subscription::Subscription() :
+    channel(),
+    id(0)
+{
+}
+
+inline Subscription::Subscription(std::weak_ptr<EventChannelBase> eventChannel, uint32_t subscriberId) :
+    channel(std::move(eventChannel)),
+    id(subscriberId)
+{
+}
+
+inline Subscription::Subscription(Subscription&& other) noexcept :
+    channel(std::move(other.channel)),
+    id(other.id)
+{
+    other.id = 0;
+}
+
+inline Subscription& Subscription::operator=(Subscription&& other) noexcept {
+    if (this != &other) {
+        reset();
+        channel = std::move(other.channel);
+        id = other.id;
+        other.id = 0;
+    }
+    return *this;
+}
+
+inline Subscription::~Subscription() {
+    reset();
+}
+
+inline void Subscription::reset() {
+    if (id != 0) {
+        if (std::shared_ptr<EventChannelBase> target = channel.lock()) {
+            target->unsubscribe(id);
+        }
+        id = 0;
+    }
+    channel.reset();
+}
+
+template <typename E>
+EventChannel<E>::EventChannel() :
+    nextId(1),
+    dispatching(false),
+    removedDuringDispatch(false)
+{
+}
+
+template <typename E>
+uint32_t EventChannel<E>::subscribe(std::function<void(const EventBatch<E>&)> callback) {
+    uint32_t id = nextId++;
+    // Growing the handler list mid-dispatch would move the callback that is running
+    std::vector<Handler>& target = dispatching ? added : handlers;
+    target.push_back(Handler{ id, std::move(callback) });
+    return id;
+}
+
+template <typename E>
+void EventChannel<E>::unsubscribe(uint32_t id) {
+    for (size_t i = 0; i < added.size(); i++) {
+        if (added[i].id == id) {
+            added.erase(added.begin() + i);
+            return;
+        }
+    }
+    for (size_t i = 0; i < handlers.size(); i++) {
+        if (handlers[i].id == id) {
+            // The handler may be the one running, so it is only marked dead
+            if (dispatching) {
+                handlers[i].id = 0;
+                removedDuringDispatch = true;
+            }
+            else {
+                handlers.erase(handlers.begin() + i);
+            }
+            return;
+        }
+    }
+}
+
+// With nobody listening there is nothing to deliver, so the event is dropped
+// instead of queued.
+template <typename E>
+void EventChannel<E>::publish(const E& event) {
+    if (handlers.empty() && added.empty()) {
+        return;
+    }
+    if (!pending.empty() && EventTraits<E>::coalesce(pending.back(), event)) {
+        return;
+    }
+    pending.push_back(event);
+}
+
+template <typename E>
+void EventChannel<E>::dispatch() {
+    if (pending.empty() || dispatching) {
+        return;
+    }
+    // Both buffers keep their capacity, so a steady frame never allocates
+    delivering.swap(pending);
+    dispatching = true;
+    EventBatch<E> batch = { delivering.data(), delivering.size() };
+    for (size_t i = 0; i < handlers.size(); i++) {
+        if (handlers[i].id != 0) {
+            handlers[i].callback(batch);
+        }
+    }
+    dispatching = false;
+    delivering.clear();
+
+    if (removedDuringDispatch) {
+        size_t kept = 0;
+        for (size_t i = 0; i < handlers.size(); i++) {
+            if (handlers[i].id != 0) {
+                if (kept != i) {
+                    handlers[kept] = std::move(handlers[i]);
+                }
+                kept++;
+            }
+        }
+        handlers.resize(kept);
+        removedDuringDispatch = false;
+    }
+    for (Handler& handler : added) {
+        handlers.push_back(std::move(handler));
+    }
+    added.clear();
+}
+
+template <typename E>
+void EventChannel<E>::clear() {
+    pending.clear();
+}
+
+template <typename E>
+EventChannel<E>& EventBus::channel() {
+    size_t index = typeIndex<E>();
+    if (index >= channels.size()) {
+        channels.resize(index + 1);
+    }
+    if (!channels[index]) {
+        channels[index] = std::make_shared<EventChannel<E>>();
+    }
+    return static_cast<EventChannel<E>&>(*channels[index]);
+}
+
+template <typename E>
+Subscription EventBus::subscribe(std::function<void(const EventBatch<E>&)> callback) {
+    channel<E>();
+    std::shared_ptr<EventChannelBase>& target = channels[typeIndex<E>()];
+    uint32_t id = static_cast<EventChannel<E>&>(*target).subscribe(std::move(callback));
+    return Subscription(target, id);
+}
+
+inline void EventBus::dispatch() {
+    for (size_t i = 0; i < channels.size(); i++) {
+        if (channels[i]) {
+            channels[i]->dispatch();
+        }
+    }
+}
+
+inline void EventBus::clear() {
+    for (size_t i = 0; i < channels.size(); i++) {
+        if (channels[i]) {
+            channels[i]->clear();
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#include "FallingObjectPool.h"
+#include "SpriteBatch.h"
+
+FallingObjectPool::FallingObjectPool(size_t maxObjects) :
+    slots(maxObjects),
+    positionX(maxObjects),
+    positionY(maxObjects),
+    previousY(maxObjects),
+    speeds(maxObjects),
+    rotations(maxObjects),
+    previousRotations(maxObjects),
+    sizes(maxObjects),
+    activeFlags(maxObjects),
+    sprites(maxObjects),
+    types(maxObjects),
+    scores(maxObjects),
+    maxSize(0.0f)
+{
+}
+
+ObjectHandle FallingObjectPool::acquire(Vector2 position, float fallingSpeed, SpriteId sprite,
+    float objectSize, ObjectType type, int score) {
+    ObjectHandle handle = slots.acquire();
+    if (!handle.isValid()) {
+        return handle;
+    }
+    size_t i = slots.size() - 1;
+    positionX[i] = position.x;
+    positionY[i] = position.y;
+    previousY[i] = position.y;
+    speeds[i] = fallingSpeed;
+    rotations[i] = 0.0f;
+    previousRotations[i] = 0.0f;
+    sizes[i] = objectSize;
+    activeFlags[i] = 1;
+    sprites[i] = sprite;
+    types[i] = type;
+    scores[i] = score;
+    if (objectSize > maxSize) {
+        maxSize = objectSize;
+    }
+    return handle;
+}
+
+bool FallingObjectPool::release(ObjectHandle handle) {
+    if (!slots.isAlive(handle)) {
+        return false;
+    }
+    releaseAt(slots.indexOf(handle));
+    return true;
+}
+
+void FallingObjectPool::releaseAt(size_t index) {
+    size_t moved = slots.releaseAt(index);
+    if (moved == index) {
+        return;
+    }
+    positionX[index] = positionX[moved];
+    positionY[index] = positionY[moved];
+    previousY[index] = previousY[moved];
+    speeds[index] = speeds[moved];
+    rotations[index] = rotations[moved];
+    previousRotations[index] = previousRotations[moved];
+    sizes[index] = sizes[moved];
+    activeFlags[index] = activeFlags[moved];
+    sprites[index] = sprites[moved];
+    types[index] = types[moved];
+    scores[index] = scores[moved];
+}
+
+MotionArrays FallingObjectPool::getMotion() {
+    return MotionArrays{
+        positionX.data(),
+        positionY.data(),
+        previousY.data(),
+        speeds.data(),
+        rotations.data(),
+        previousRotations.data(),
+        sizes.data(),
+        activeFlags.data()
+    };
+}
+
+void FallingObjectPool::writeSprites(std::vector<ObjectSprite>& out) const {
+    out.clear();
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (!activeFlags[i]) {
+            continue;
+        }
+        out.push_back(ObjectSprite{
+            sprites[i], positionX[i], previousY[i], positionY[i],
+            previousRotations[i], rotations[i], sizes[i]
+        });
+    }
+}
+
+void FallingObjectPool::render(SpriteBatch& batch, const std::vector<ObjectSprite>& sprites, float alpha) {
+    for (const ObjectSprite& object : sprites) {
+        float drawY = object.previousY + (object.y - object.previousY) * alpha;
+        float angle = object.previousRotation + (object.rotation - object.previousRotation) * alpha;
+        batch.draw(
+            object.sprite,
+            Rectangle{ object.x, drawY, object.size, object.size },
+            Vector2{ object.size / 2, object.size / 2 },
+            angle,
+            WHITE
+        );
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "raylib.h"
+#include "ObjectPool.h"
+#include "MotionKernels.h"
+#include "TextureAtlas.h"
+#include <vector>
+
+class SpriteBatch;
+
+enum class ObjectType {
+    DIAMOND,
+    RUBY,
+    AMETHYST,
+    GOLDBAR,
+    SILVERBAR,
+    DYNAMITE,
+    COUNT
+};
+
+// One object as render() draws it, blending between the last two ticks
+struct ObjectSprite {
+    SpriteId sprite;
+    float x;
+    float previousY;
+    float y;
+    float previousRotation;
+    float rotation;
+    float size;
+};
+
+// The falling objects, one array per field. The hot fields are updated and
+// collision-tested through MotionKernels several objects at a time; sprite,
+// type and score are only read when an object is drawn or caught. Packing
+// and handles work as described for SlotTable.
+class FallingObjectPool {
+private:
+    SlotTable slots;
+
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> previousY;
+    std::vector<float> speeds;
+    std::vector<float> rotations;
+    std::vector<float> previousRotations;
+    std::vector<float> sizes;
+    std::vector<uint32_t> activeFlags;
+
+    std::vector<SpriteId> sprites;
+    std::vector<ObjectType> types;
+    std::vector<int> scores;
+    // Largest size acquired since the last clear, for the broad phase
+    float maxSize;
+
+public:
+    explicit FallingObjectPool(size_t maxObjects);
+
+    ObjectHandle acquire(Vector2 position, float fallingSpeed, SpriteId sprite,
+        float objectSize, ObjectType type, int score);
+    bool release(ObjectHandle handle);
+    void releaseAt(size_t index);
+    void clear() { slots.clear(); maxSize = 0.0f; }
+
+    bool isAlive(ObjectHandle handle) const { return slots.isAlive(handle); }
+    size_t indexOf(ObjectHandle handle) const { return slots.indexOf(handle); }
+    ObjectHandle handleAt(size_t index) const { return slots.handleAt(index); }
+
+    MotionArrays getMotion();
+    // Copies the active objects out for drawing. out never grows past the
+    // pool's capacity, so reserving that much up front keeps this allocation free.
+    void writeSprites(std::vector<ObjectSprite>& out) const;
+    // alpha blends from the previous tick's state (0) to the current one (1)
+    static void render(SpriteBatch& batch, const std::vector<ObjectSprite>& sprites, float alpha);
+
+    Vector2 getPosition(size_t index) const { return Vector2{ positionX[index], positionY[index] }; }
+    float getSize(size_t index) const { return sizes[index]; }
+    float getMaxSize() const { return maxSize; }
+    bool isActive(size_t index) const { return activeFlags[index] != 0; }
+    ObjectType getType(size_t index) const { return types[index]; }
+    int getScore(size_t index) const { return scores[index]; }
+    void setActive(size_t index, bool isActive) { activeFlags[index] = isActive ? 1 : 0; }
+
+    size_t size() const { return slots.size(); }
+    size_t capacity() const { return slots.capacity(); }
+    bool isFull() const { return slots.isFull(); }
+    bool isEmpty() const { return slots.isEmpty(); }
+};
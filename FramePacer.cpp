@@ -0,0 +1,117 @@
+#include "FramePacer.h"
+#include "Platform.h"
+#include <algorithm>
+#include <thread>
+
+// An OS sleep this close to the deadline risks overshooting it
+static const std::chrono::microseconds SPIN_WINDOW(2000);
+// Slack left between the predicted end of a low-latency frame and its slot
+static const std::chrono::microseconds LOW_LATENCY_MARGIN(1000);
+static const std::chrono::microseconds EVENT_PUMP_INTERVAL(1000);
+
+static const size_t WORK_HISTORY = 30;
+static const size_t LATENCY_HISTORY = 1024;
+
+LatencyStats::LatencyStats(size_t maxSamples) :
+    samples(maxSamples),
+    sorted(maxSamples),
+    totalSamples(0)
+{
+}
+
+void LatencyStats::record(float milliseconds) {
+    samples.push(milliseconds);
+    totalSamples++;
+}
+
+float LatencyStats::percentile(float fraction) const {
+    if (samples.isEmpty()) {
+        return 0.0f;
+    }
+    size_t count = samples.size();
+    for (size_t i = 0; i < count; i++) {
+        sorted[i] = samples[i];
+    }
+    size_t rank = (size_t)(fraction * (count - 1) + 0.5f);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + count);
+    return sorted[rank];
+}
+
+FramePacer::FramePacer(PacingPolicy pacingPolicy, int rate, bool lowLatencyMode) :
+    policy(pacingPolicy),
+    lowLatency(lowLatencyMode),
+    period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / (rate > 0 ? rate : 60)))),
+    nextSlot(Clock::now()),
+    frameStart(Clock::now()),
+    recentWork(WORK_HISTORY),
+    latency(LATENCY_HISTORY),
+    eventSource(nullptr)
+{
+}
+
+FramePacer::Clock::duration FramePacer::predictWork() const {
+    float slowest = 0.0f;
+    for (size_t i = 0; i < recentWork.size(); i++) {
+        slowest = recentWork[i] > slowest ? recentWork[i] : slowest;
+    }
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(slowest)) + LOW_LATENCY_MARGIN;
+}
+
+void FramePacer::waitUntil(Clock::time_point deadline) {
+    for (;;) {
+        Clock::duration remaining = deadline - Clock::now();
+        if (remaining <= Clock::duration::zero()) {
+            return;
+        }
+        if (remaining > SPIN_WINDOW) {
+            Clock::duration sleepFor = remaining - SPIN_WINDOW;
+            if (eventSource != nullptr) {
+                sleepFor = sleepFor < EVENT_PUMP_INTERVAL ? sleepFor : EVENT_PUMP_INTERVAL;
+            }
+            std::this_thread::sleep_for(sleepFor);
+            if (eventSource != nullptr) {
+                eventSource->pumpEvents();
+            }
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool FramePacer::waitForFrame() {
+    Clock::time_point start = Clock::now();
+    bool waits = policy == PacingPolicy::CAP || (policy == PacingPolicy::VSYNC && lowLatency);
+    if (waits) {
+        start = nextSlot - (lowLatency ? predictWork() : period);
+        waitUntil(start);
+    }
+    frameStart = Clock::now();
+    return waits;
+}
+
+void FramePacer::framePresented() {
+    Clock::time_point now = Clock::now();
+    recentWork.push(std::chrono::duration<float>(now - frameStart).count());
+    if (policy == PacingPolicy::VSYNC) {
+        // The swap returned on a refresh, so the next one is a period away
+        nextSlot = now + period;
+        return;
+    }
+    nextSlot += period;
+    // After a stall, start a new cadence rather than rushing to catch up
+    if (nextSlot < now) {
+        nextSlot = now + period;
+    }
+}
+
+void FramePacer::recordLatency(Clock::time_point inputTime) {
+    latency.record(std::chrono::duration<float, std::milli>(Clock::now() - inputTime).count());
+}
+
+float FramePacer::getBudget() const {
+    if (policy == PacingPolicy::UNCAPPED) {
+        return 0.0f;
+    }
+    return std::chrono::duration<float>(period).count();
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "RingBuffer.h"
+#include <chrono>
+#include <vector>
+
+class Platform;
+
+enum class PacingPolicy {
+    CAP,        // frames start on a fixed cadence
+    VSYNC,      // the swap waits for the display's refresh
+    UNCAPPED
+};
+
+// The newest input-to-present latencies, in milliseconds. Storage is
+// allocated once, so recording never allocates.
+class LatencyStats {
+private:
+    RingBuffer<float> samples;
+    mutable std::vector<float> sorted;
+    unsigned long long totalSamples;
+
+public:
+    explicit LatencyStats(size_t maxSamples);
+
+    void record(float milliseconds);
+    // fraction runs from 0 to 1, e.g. 0.95 for the 95th percentile
+    float percentile(float fraction) const;
+    size_t size() const { return samples.size(); }
+    unsigned long long getTotalSamples() const { return totalSamples; }
+};
+
+// Decides when each frame starts. A wait sleeps while the deadline is far
+// off and spins through the last stretch, since an OS sleep can overshoot by
+// a millisecond or more. Input should be polled straight after the wait, so
+// the simulation reads it as fresh as possible.
+//
+// Low-latency mode starts each frame as late as it can and still make its
+// present slot, judging by the slowest recent frame. That matters with
+// vsync: the frame no longer starts right after one refresh and then sits
+// in the swap until the next. With a fixed cap, frames start on the cadence
+// either way.
+class FramePacer {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    PacingPolicy policy;
+    bool lowLatency;
+    Clock::duration period;
+    Clock::time_point nextSlot;
+    Clock::time_point frameStart;
+    // Seconds from frame start to present
+    RingBuffer<float> recentWork;
+    LatencyStats latency;
+    Platform* eventSource;
+
+    Clock::duration predictWork() const;
+    void waitUntil(Clock::time_point deadline);
+
+public:
+    // rate is the cap in frames per second, or the display's refresh rate
+    // with VSYNC
+    FramePacer(PacingPolicy pacingPolicy, int rate, bool lowLatencyMode);
+
+    // While it sleeps, the pacer pumps platform's key events every
+    // millisecond, so the callback times them closely. nullptr stops that.
+    void setEventSource(Platform* platform) { eventSource = platform; }
+    // Returns true when it waited, in which case input should be polled again
+    bool waitForFrame();
+    // Call as soon as the swap returns
+    void framePresented();
+    // inputTime is when the input the presented frame reflects was sampled
+    void recordLatency(Clock::time_point inputTime);
+
+    // Seconds a frame may take, 0 when uncapped
+    float getBudget() const;
+    PacingPolicy getPolicy() const { return policy; }
+    bool isLowLatency() const { return lowLatency; }
+    const LatencyStats& getLatency() const { return latency; }
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "raylib.h"
+#include "EventBus.h"
+
+enum class ObjectType;
+
+enum class StateId {
+    NONE,
+    LOADING,
+    TITLE,
+    GAMEPLAY,
+    GAME_OVER,
+    COUNT
+};
+
+// Published by GameplayState during a tick and delivered once per frame by
+// GameManager::advance.
+struct SpawnEvent {
+    ObjectType type;
+    Vector2 position;
+};
+
+struct GemCollectedEvent {
+    ObjectType type;
+    int points;
+    Vector2 position;
+};
+
+struct ExplosionEvent {
+    Vector2 position;
+};
+
+struct StateChangeEvent {
+    StateId from;
+    StateId to;
+};
+
+// Several transitions in one frame (a replay at high speed) reach listeners
+// as the net change.
+template <>
+struct EventTraits<StateChangeEvent> {
+    static bool coalesce(StateChangeEvent& previous, const StateChangeEvent& next) {
+        previous.to = next.to;
+        return true;
+    }
+};
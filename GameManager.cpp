@@ -4,24 +4,127 @@
 #include "GameStates.h"
 #include "ObjectFactory.h"
 #include "ScoreSystem.h"
-#include <cstdlib>
+#include "BroadPhase.h"
+#include "GameEvents.h"
+#include "TextureAtlas.h"
+#include "SpriteBatch.h"
+#include "TextLayout.h"
+#include "Replay.h"
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "Platform.h"
+#include "Renderer.h"
+#include "ResolutionScaler.h"
+#include "FramePacer.h"
+#include "AudioDevice.h"
+#include "VoicePool.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "SpawnTable.h"
+#include "RenderSnapshot.h"
+#include "TripleBuffer.h"
+#include "Leaderboard.h"
+#include <chrono>
+#include <cmath>
 #include <ctime>
+#include <thread>
 
 GameManager* GameManager::instance = nullptr;
 
+// A long stall (window drag, breakpoint) is dropped instead of being caught up
+// in one burst of ticks.
+static const float MAX_FRAME_TIME = 0.25f;
+
+// A still screen with music playing still wakes this often to stream it
+static const float IDLE_WAKE_SECONDS = 0.05f;
+
+static const int MAX_LOADER_THREADS = 4;
+static const int MAX_JOB_THREADS = 16;
+
+// Collects may overlap a little but never crowd out the explosion
+static const int MAX_SOUND_VOICES = 6;
+static const SoundEffectConfig COLLECT_SOUND_CONFIG = { 4, 1, 2 };
+static const SoundEffectConfig EXPLOSION_SOUND_CONFIG = { 2, 10, 1 };
+
+static std::chrono::steady_clock::time_point startupBegin;
+
+// Decoded data handed from the loader's worker threads to the main thread.
+// With an asset pack the images point into the mapping instead.
+struct PendingAssets {
+    bool packed;
+    Image sprites[SPRITE_ASSET_COUNT];
+    DecodedFont font;
+    Wave waves[ASSET_COUNT];
+};
+
 GameManager::GameManager() :
+    platform(nullptr),
+    renderer(nullptr),
+    audio(nullptr),
+    resolutionScaler(nullptr),
+    fixedResolutionScale(0.0f),
+    framePacer(nullptr),
+    pacingPolicy(PacingPolicy::CAP),
+    pacingRate(60),
+    lowLatency(false),
+    measuredInput(),
+    states(),
     currentState(nullptr),
+    pendingState(StateId::NONE),
     inputHandler(nullptr),
     scoreSystem(nullptr),
     objectFactory(nullptr),
+    broadPhase(nullptr),
+    eventBus(nullptr),
+    jobSystem(nullptr),
+    jobThreads(0),
     player(nullptr),
+    assetLoader(nullptr),
+    assetPack(nullptr),
+    pendingAssets(nullptr),
+    assetsReady(false),
+    startupMs(0.0),
+    pixelFont(),
+    atlas(nullptr),
+    spriteBatch(nullptr),
+    textCache(nullptr),
+    voicePool(nullptr),
+    snapshots(nullptr),
+    threadedSimulation(false),
+    simulationThread(),
+    simulationRunning(false),
+    simulationPaused(false),
+    stateLayers(),
+    presentedState(StateId::NONE),
+    presentedKey(0),
+    suspended(false),
+    musicWanted(false),
+    musicStarts(0),
+    musicStartsApplied(0),
+    collectTriggers(0),
+    explosionTriggers(0),
     screenFlash(false),
     flashAlpha(0.0f),
     flashTimer(0.0f),
     screenWidth(800),
     screenHeight(450),
+    objectCapacity(ObjectFactory::DEFAULT_POOL_CAPACITY),
+    spawnTablePath(SpawnTable::DEFAULT_PATH),
+    leaderboard(nullptr),
+    leaderboardPath(),
     spawnTimer(0.0f),
-    spawnInterval(1.0f)
+    spawnInterval(1.0f),
+    lastFrameTime(0.0f),
+    tickEndTime(0.0),
+    simulationStep(1.0f / 60.0f),
+    accumulator(0.0f),
+    interpolationAlpha(1.0f),
+    timeScale(1.0f),
+    lockstep(false),
+    randomSeed(0),
+    replayRecorder(nullptr),
+    replayPlayer(nullptr),
+    replayFinished(false)
 {
 }
 
@@ -32,91 +135,638 @@ GameManager* GameManager::getInstance() {
     return instance;
 }
 
-void GameManager::initialize() {
-    InitWindow(screenWidth, screenHeight, "Collect D'Gems");
-    InitAudioDevice();
-    collectSound = LoadSound("Resources/collect.mp3");
-    explodeSound = LoadSound("Resources/explode.mp3");
-    bgm = LoadMusicStream("Resources/bgm.mp3");
-    SetMusicVolume(bgm, 0.5f);
+void GameManager::initialize(bool headless) {
+    startupBegin = std::chrono::steady_clock::now();
+    if (headless) {
+        platform = new NullPlatform();
+        renderer = new NullRenderer();
+        audio = new NullAudioDevice();
+    }
+    else {
+        platform = new RaylibPlatform();
+        renderer = new RaylibRenderer();
+        audio = new RaylibAudioDevice();
+    }
 
-    srand(time(NULL));
+    platform->openWindow(screenWidth, screenHeight, "Collect D'Gems");
+    // screenWidth and screenHeight are logical units from here on, whatever
+    // the window or the render resolution
+    renderer->setLogicalSize(screenWidth, screenHeight);
+    resolutionScaler = new ResolutionScaler();
+    audio->open();
+    voicePool = new VoicePool(audio, MAX_SOUND_VOICES);
 
-    pixelFont = LoadFont("Resources/pixelated.ttf");
-    background = LoadTexture("Resources/BG.png");
-    railLeft = LoadTexture("Resources/RailLeft.png");
-    railMid = LoadTexture("Resources/RailMid.png");
-    railRight = LoadTexture("Resources/RailRight.png");
+    // Every random value comes from the streams seeded here, so this seed plus
+    // the per-tick input is enough to replay a session exactly
+    setRandomSeed((unsigned int)time(NULL));
 
-    inputHandler = new InputHandler();
+    atlas = new TextureAtlas();
+    spriteBatch = new SpriteBatch(renderer, atlas, objectCapacity + 64);
+    textCache = new TextLayoutCache(renderer, 256);
+
+    inputHandler = new InputHandler(platform);
     scoreSystem = new ScoreSystem();
-    objectFactory = new ObjectFactory();
+    leaderboard = new Leaderboard();
+    if (!leaderboardPath.empty() && leaderboard->open(leaderboardPath.c_str())) {
+        scoreSystem->setHighScore(leaderboard->getBestScore());
+    }
+    objectFactory = new ObjectFactory(objectCapacity);
+    if (!objectFactory->getSpawnTable().load(spawnTablePath.c_str())) {
+        TraceLog(LOG_INFO, "SPAWN: using the built-in spawn table");
+    }
+    broadPhase = new BroadPhase();
+    eventBus = new EventBus();
+    setJobThreads(jobThreads);
+
+    states[static_cast<int>(StateId::LOADING)] = new LoadingState();
+    states[static_cast<int>(StateId::TITLE)] = new TitleState();
+    states[static_cast<int>(StateId::GAMEPLAY)] = new GameplayState(objectCapacity);
+    states[static_cast<int>(StateId::GAME_OVER)] = new GameOverState();
+    snapshots = new TripleBuffer<RenderSnapshot>(objectCapacity);
+
+    assetPack = new AssetPack();
+    if (!assetPack->open(AssetPack::DEFAULT_PATH)) {
+        TraceLog(LOG_INFO, "ASSET: no asset pack, loading loose files");
+    }
+    pendingAssets = new PendingAssets();
+    pendingAssets->packed = assetPack->isOpen();
+    assetLoader = new AssetLoader();
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        queueAsset(static_cast<AssetId>(i));
+    }
+
+    int workers = (int)std::thread::hardware_concurrency() - 1;
+    assetLoader->start(workers < MAX_LOADER_THREADS ? workers : MAX_LOADER_THREADS);
+    applyFramePacing();
+
+    // Without a window there is no loading screen to show
+    if (headless) {
+        assetLoader->wait();
+        finishLoading();
+        changeState(StateId::TITLE);
+    }
+    else {
+        changeState(StateId::LOADING);
+    }
+    applyPendingState();
+    publishSnapshot(1.0f);
+}
+
+// From the pack, assets are already decoded and only the upload step is left.
+// Loose files are decoded on a worker thread first; textures, sounds and the
+// music stream are still created on this thread.
+void GameManager::queueAsset(AssetId id) {
+    int index = static_cast<int>(id);
+    const char* fileName = getAssetInfo(id).fileName;
+    Renderer* assetRenderer = renderer;
+    AudioDevice* assetAudio = audio;
+    AssetPack* pack = assetPack->isOpen() ? assetPack : nullptr;
+    PendingAssets* pending = pendingAssets;
+    Sound* sound = id == AssetId::SOUND_COLLECT ? &collectSound : &explodeSound;
+
+    switch (getAssetInfo(id).kind) {
+    case AssetKind::IMAGE:
+        if (pack != nullptr) {
+            assetLoader->add(fileName, nullptr, [=] { pending->sprites[index] = pack->getImage(id); });
+        }
+        else {
+            assetLoader->add(fileName, [=] { pending->sprites[index] = assetRenderer->loadImage(fileName); }, nullptr);
+        }
+        break;
+
+    case AssetKind::FONT:
+        if (pack != nullptr) {
+            assetLoader->add(fileName, nullptr, [=] {
+                DecodedFont decoded;
+                decoded.font = pack->loadFont(id, &decoded.atlas);
+                pixelFont = assetRenderer->uploadFont(decoded);
+            });
+        }
+        else {
+            assetLoader->add(fileName,
+                [=] { pending->font = assetRenderer->decodeFont(fileName); },
+                [=] {
+                    pixelFont = assetRenderer->uploadFont(pending->font);
+                    assetRenderer->unloadImage(pending->font.atlas);
+                });
+        }
+        break;
+
+    case AssetKind::SOUND:
+        if (pack != nullptr) {
+            assetLoader->add(fileName, nullptr, [=] { *sound = assetAudio->loadSoundFromWave(pack->getWave(id)); });
+        }
+        else {
+            assetLoader->add(fileName,
+                [=] { pending->waves[index] = assetAudio->loadWave(fileName); },
+                [=] {
+                    *sound = assetAudio->loadSoundFromWave(pending->waves[index]);
+                    assetAudio->unloadWave(pending->waves[index]);
+                });
+        }
+        break;
+
+    // Music is streamed and decoded while it plays, so only opening it is left
+    case AssetKind::MUSIC:
+        assetLoader->add(fileName, nullptr, [=] {
+            if (pack != nullptr) {
+                int size = 0;
+                const unsigned char* data = pack->getBytes(id, &size);
+                bgm = assetAudio->loadMusicFromMemory(".mp3", data, size);
+            }
+            else {
+                bgm = assetAudio->loadMusic(fileName);
+            }
+            assetAudio->setMusicVolume(bgm, 0.5f);
+        });
+        break;
+    }
+}
+
+// Called on the main thread once every asset has been uploaded. Builds what
+// depends on the assets and reports how long each one took.
+void GameManager::finishLoading() {
+    auto atlasStart = std::chrono::steady_clock::now();
+    atlas->build(renderer, pendingAssets->sprites);
+    if (!pendingAssets->packed) {
+        for (const Image& image : pendingAssets->sprites) {
+            renderer->unloadImage(image);
+        }
+    }
+    double atlasMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - atlasStart).count();
+
+    voicePool->addEffect(SoundEffect::COLLECT, collectSound, COLLECT_SOUND_CONFIG);
+    voicePool->addEffect(SoundEffect::EXPLOSION, explodeSound, EXPLOSION_SOUND_CONFIG);
 
-    int trackY = screenHeight - railMid.height;
+    int trackY = screenHeight - atlas->getHeight(SpriteId::RAIL_MID);
     player = new Player(Vector2{ screenWidth / 2.0f, (float)trackY }, 5.0f, 50.0f);
 
-    GameState* titleState = new TitleState();
-    changeState(titleState);
-    SetTargetFPS(60);
+    assetLoader->forEachTiming([](const AssetTiming& timing) {
+        TraceLog(LOG_INFO, "ASSET: %s decoded in %.2f ms, uploaded in %.2f ms",
+            timing.name, timing.decodeMs, timing.uploadMs);
+    });
+    TraceLog(LOG_INFO, "ASSET: sprite atlas packed and uploaded in %.2f ms", atlasMs);
+
+    delete assetLoader;
+    assetLoader = nullptr;
+    delete pendingAssets;
+    pendingAssets = nullptr;
+
+    assetsReady = true;
+    inputHandler->listen();
+    framePacer->setEventSource(inputHandler->hasPlatformEvents() ? platform : nullptr);
+    startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+    TraceLog(LOG_INFO, "ASSET: startup took %.2f ms", startupMs);
+}
+
+void GameManager::setFramePacing(PacingPolicy policy, int rate, bool lowLatencyMode) {
+    pacingPolicy = policy;
+    pacingRate = rate;
+    lowLatency = lowLatencyMode;
+    if (platform != nullptr) {
+        applyFramePacing();
+    }
+}
+
+void GameManager::applyFramePacing() {
+    PacingPolicy policy = platform->isHeadless() ? PacingPolicy::UNCAPPED : pacingPolicy;
+    // The pacer does all the waiting; raylib's own limiter would only add to it
+    platform->setTargetFPS(0);
+    platform->setVsync(policy == PacingPolicy::VSYNC);
+    int rate = policy == PacingPolicy::VSYNC ? platform->getRefreshRate() : pacingRate;
+    delete framePacer;
+    framePacer = new FramePacer(policy, rate, lowLatency);
+    if (inputHandler != nullptr && inputHandler->hasPlatformEvents()) {
+        framePacer->setEventSource(platform);
+    }
+}
+
+void GameManager::waitForFrame() {
+    PROFILE_SCOPE("GameManager::waitForFrame");
+    // Sample input once the wait is over, so the frame acts on the freshest
+    if (framePacer->waitForFrame()) {
+        platform->pollInput();
+    }
+}
+
+// Polling the platform again drops key presses it saw since the last poll,
+// so whatever polls it calls this straight after
+void GameManager::sampleInput() {
+    if (replayPlayer == nullptr && assetsReady) {
+        inputHandler->poll();
+    }
+}
+
+// The main thread's part of a frame. Unless the simulation has a thread of
+// its own, the frame's ticks run here too.
+void GameManager::advance(float frameTime) {
+    lastFrameTime = frameTime;
+    sampleInput();
+    if (assetsReady) {
+        updateBackgroundMusic();
+    }
+#ifdef COLLECTDGEMS_PROFILER
+    // F3 shows the profiler overlay, F4 dumps a Chrome trace
+    if (platform->isKeyPressed(KEY_F3)) {
+        Profiler::getInstance()->toggleOverlay();
+    }
+    if (platform->isKeyPressed(KEY_F4)) {
+        Profiler::getInstance()->writeChromeTrace("profile_trace.json");
+    }
+#endif
+    // Loading always runs here, since textures can only be created on the
+    // main thread
+    if (threadedSimulation && assetsReady) {
+        if (!simulationThread.joinable()) {
+            simulationRunning.store(true);
+            simulationThread = std::thread([this] { runSimulation(); });
+        }
+    }
+    else if (!simulationPaused.load()) {
+        simulate(frameTime);
+    }
+    if (assetsReady) {
+        playQueuedSounds();
+    }
+}
+
+// Runs as many fixed-size ticks as the elapsed time covers. What is left over
+// becomes the blend factor between the last two ticks for render().
+void GameManager::simulate(float frameTime) {
+    // Editing the table mid-replay would change what the recording sees
+    if (replayRecorder == nullptr && replayPlayer == nullptr) {
+        objectFactory->getSpawnTable().pollForChanges(frameTime);
+    }
+    double now = platform->getTime();
+    if (lockstep) {
+        tickEndTime = now;
+        update(simulationStep);
+        eventBus->dispatch();
+        publishSnapshot(1.0f);
+        return;
+    }
+    float elapsed = frameTime * timeScale;
+    float maxElapsed = MAX_FRAME_TIME * (timeScale > 1.0f ? timeScale : 1.0f);
+    accumulator += elapsed < maxElapsed ? elapsed : maxElapsed;
+
+    while (accumulator >= simulationStep && !isReplayFinished()) {
+        // Ticks lag real time by what is left in the accumulator
+        tickEndTime = now - (accumulator - simulationStep) / timeScale;
+        update(simulationStep);
+        accumulator -= simulationStep;
+    }
+    float alpha = accumulator / simulationStep;
+
+    // Listeners see everything this frame's ticks published in one batch
+    eventBus->dispatch();
+    publishSnapshot(alpha < 1.0f ? alpha : 1.0f);
+}
+
+// The simulation thread. It keeps its own clock and sleeps until the next
+// tick is due, so its pace does not depend on the display's.
+void GameManager::runSimulation() {
+    auto previous = std::chrono::steady_clock::now();
+    while (simulationRunning.load() && !isReplayFinished()) {
+        auto now = std::chrono::steady_clock::now();
+        // Time spent paused is skipped, not caught up afterwards
+        if (simulationPaused.load()) {
+            previous = now;
+            std::this_thread::sleep_for(std::chrono::duration<float>(IDLE_WAKE_SECONDS));
+            continue;
+        }
+        simulate(std::chrono::duration<float>(now - previous).count());
+        previous = now;
+        if (!lockstep) {
+            float wait = (simulationStep - accumulator) / timeScale;
+            std::this_thread::sleep_for(std::chrono::duration<float>(wait));
+        }
+    }
+}
+
+void GameManager::stopSimulationThread() {
+    threadedSimulation = false;
+    if (simulationThread.joinable()) {
+        simulationRunning.store(false);
+        simulationThread.join();
+    }
+}
+
+void GameManager::publishSnapshot(float alpha) {
+    RenderSnapshot& snapshot = snapshots->getBack();
+    snapshot.state = currentState != nullptr ? currentState->getId() : StateId::NONE;
+    objectFactory->getPool().writeSprites(snapshot.objects);
+    if (player != nullptr) {
+        snapshot.player = *player;
+    }
+    scoreSystem->writeSnapshot(snapshot.score);
+    snapshot.screenFlash = screenFlash;
+    snapshot.flashAlpha = flashAlpha;
+    snapshot.interpolationAlpha = alpha;
+    snapshot.publishedAt = std::chrono::steady_clock::now();
+    snapshot.inputSampledAt = inputHandler->takeConsumedChange();
+    snapshots->publish();
+}
+
+const RenderSnapshot& GameManager::acquireSnapshot() {
+    return snapshots->acquire();
 }
 
 void GameManager::update(float deltaTime) {
-    UpdateMusicStream(bgm);
+    PROFILE_SCOPE("GameManager::update");
+    // Nothing is simulated or recorded until the assets are in
+    if (!assetsReady) {
+        if (currentState) {
+            currentState->update(deltaTime);
+        }
+        applyPendingState();
+        return;
+    }
+
+    InputFrame frame;
+    if (replayPlayer != nullptr) {
+        bool hasFrame = replayPlayer->next(frame, deltaTime);
+        replayFinished.store(replayPlayer->isFinished());
+        if (!hasFrame) {
+            return;
+        }
+    }
+    else {
+        frame = inputHandler->consume(tickEndTime, deltaTime / timeScale);
+    }
+    if (replayRecorder != nullptr) {
+        replayRecorder->record(frame, deltaTime);
+    }
+    inputHandler->setFrame(frame);
     updateScreenFlash(deltaTime);
-    updateSpawnTimer(deltaTime);
 
     if (currentState) {
         currentState->update(deltaTime);
     }
+    applyPendingState();
 }
 
 void GameManager::render() {
-    BeginDrawing();
-    ClearBackground(RAYWHITE);
-    DrawTexture(background, 0, 0, WHITE);
+    PROFILE_SCOPE("GameManager::render");
+    const RenderSnapshot& snapshot = snapshots->acquire();
+    // A minimized or unfocused window neither simulates nor draws until it
+    // is back
+    if (platform->isSuspended()) {
+        setSuspended(true);
+        platform->waitForInput(-1.0f);
+        sampleInput();
+        return;
+    }
+    setSuspended(false);
 
-    if (currentState) {
-        currentState->render();
+    GameState* state = snapshot.state != StateId::NONE ? getState(snapshot.state) : nullptr;
+    unsigned long long staticKey = state != nullptr ? state->getStaticKey(snapshot) : 0;
+    if (isFrameUnchanged(snapshot, staticKey)) {
+        platform->waitForInput(musicWanted.load() ? IDLE_WAKE_SECONDS : -1.0f);
+        sampleInput();
+        return;
     }
-    if (screenFlash) {
-        DrawRectangle(0, 0, screenWidth, screenHeight, ColorAlpha(RED, flashAlpha));
+
+    interpolationAlpha = snapshot.interpolationAlpha;
+    // The simulation thread has moved on since it published, so keep blending
+    // towards the tick it is working on
+    if (simulationThread.joinable() && !lockstep) {
+        float sincePublished = std::chrono::duration<float>(
+            std::chrono::steady_clock::now() - snapshot.publishedAt).count();
+        interpolationAlpha += sincePublished * timeScale / simulationStep;
+        if (interpolationAlpha > 1.0f) {
+            interpolationAlpha = 1.0f;
+        }
     }
+    // Without a frame cap there is no budget to scale against
+    if (fixedResolutionScale > 0.0f) {
+        renderer->setResolutionScale(fixedResolutionScale);
+    }
+    else if (framePacer->getBudget() > 0.0f) {
+        renderer->setResolutionScale(resolutionScaler->update(lastFrameTime, framePacer->getBudget()));
+    }
+#ifdef COLLECTDGEMS_PROFILER
+    Profiler::getInstance()->setCounter("resolution scale", renderer->getResolutionScale());
+    const VoiceStats& voiceStats = voicePool->getLastFrameStats();
+    Profiler::getInstance()->setCounter("sound voices active", (float)voiceStats.activeVoices);
+    Profiler::getInstance()->setCounter("sound voices stolen", (float)voiceStats.stolen);
+    Profiler::getInstance()->setCounter("sound triggers dropped",
+        (float)(voiceStats.droppedRateLimit + voiceStats.droppedNoVoice));
+#endif
+
+    // The background and whatever the state keeps still are redrawn only
+    // when they change, and otherwise cost one quad
+    RenderLayer* layer = nullptr;
+    if (assetsReady && state != nullptr) {
+        layer = &stateLayers[static_cast<int>(snapshot.state)];
+        if (!layer->valid || layer->key != staticKey || !renderer->isLayerCurrent(*layer)) {
+            PROFILE_SCOPE("GameManager::renderStatic");
+            renderer->beginLayer(*layer);
+            spriteBatch->draw(SpriteId::BACKGROUND, 0, 0, WHITE);
+            spriteBatch->flush();
+            state->renderStatic(snapshot);
+            spriteBatch->flush();
+            renderer->endLayer();
+            layer->key = staticKey;
+            layer->valid = true;
+        }
+    }
+
+    renderer->beginFrame(RAYWHITE);
+    if (layer != nullptr) {
+        renderer->drawLayer(*layer);
+    }
+    if (state != nullptr) {
+        state->render(snapshot);
+    }
+    if (snapshot.screenFlash) {
+        renderer->drawRectangle(0, 0, screenWidth, screenHeight, ColorAlpha(RED, snapshot.flashAlpha));
+    }
+    bool overlayVisible = false;
+#ifdef COLLECTDGEMS_PROFILER
+    overlayVisible = Profiler::getInstance()->isOverlayVisible();
+    if (overlayVisible) {
+        Profiler::getInstance()->renderOverlay(renderer, screenWidth);
+    }
+#endif
+
+    renderer->endFrame();
+    framePacer->framePresented();
+    // endFrame() polled the platform too
+    sampleInput();
+    if (snapshot.inputSampledAt != std::chrono::steady_clock::time_point()
+        && snapshot.inputSampledAt != measuredInput) {
+        measuredInput = snapshot.inputSampledAt;
+        framePacer->recordLatency(snapshot.inputSampledAt);
+#ifdef COLLECTDGEMS_PROFILER
+        Profiler::getInstance()->setCounter("input latency p95 ms", framePacer->getLatency().percentile(0.95f));
+#endif
+    }
+
+    bool still = layer != nullptr && !state->isAnimated() && !snapshot.screenFlash && !overlayVisible;
+    presentedState = still ? snapshot.state : StateId::NONE;
+    presentedKey = staticKey;
+}
+
+// True when the window already shows exactly what this frame would draw and
+// nothing is waiting to be handled: a still screen with no input held, no
+// replay feeding input and no resize
+bool GameManager::isFrameUnchanged(const RenderSnapshot& snapshot, unsigned long long staticKey) const {
+    if (platform->isHeadless() || replayPlayer != nullptr || !assetsReady) {
+        return false;
+    }
+    if (presentedState == StateId::NONE || snapshot.state != presentedState || staticKey != presentedKey
+        || snapshot.screenFlash) {
+        return false;
+    }
+#ifdef COLLECTDGEMS_PROFILER
+    if (Profiler::getInstance()->isOverlayVisible()) {
+        return false;
+    }
+#endif
+    return !inputHandler->hasPendingInput() && !platform->isWindowResized();
+}
 
-    EndDrawing();
+void GameManager::setSuspended(bool suspend) {
+    if (suspend == suspended) {
+        return;
+    }
+    suspended = suspend;
+    simulationPaused.store(suspend);
+    if (suspend) {
+        audio->pauseMusic(bgm);
+    }
+    else {
+        audio->resumeMusic(bgm);
+    }
 }
 
 void GameManager::cleanup() {
-    delete currentState;
+    stopSimulationThread();
+    // Closing the window mid-load still has to join the workers and release
+    // what they decoded
+    if (assetLoader != nullptr) {
+        assetLoader->wait();
+        finishLoading();
+    }
+
+    // A run cut short by closing the window still goes on the record
+    if (currentState != nullptr && currentState->getId() == StateId::GAMEPLAY) {
+        static_cast<GameplayState*>(currentState)->endRun(RunEnd::QUIT);
+    }
+    delete leaderboard;
+
+    delete replayRecorder;
+    delete replayPlayer;
+
+    for (GameState* state : states) {
+        delete state;
+    }
+    currentState = nullptr;
+    delete snapshots;
     delete inputHandler;
     delete scoreSystem;
     delete objectFactory;
+    delete broadPhase;
+    delete eventBus;
+    delete jobSystem;
     delete player;
 
-    UnloadFont(pixelFont);
-    UnloadTexture(background);
-    UnloadTexture(railLeft);
-    UnloadTexture(railMid);
-    UnloadTexture(railRight);
+    delete spriteBatch;
+    delete textCache;
+    delete resolutionScaler;
+    delete framePacer;
+    framePacer = nullptr;
+    for (RenderLayer& layer : stateLayers) {
+        renderer->unloadLayer(layer);
+    }
+    renderer->unloadFrameTarget();
+    renderer->unloadFont(pixelFont);
+    atlas->unload(renderer);
+    delete atlas;
 
-    UnloadSound(collectSound);
-    UnloadSound(explodeSound);
-    UnloadMusicStream(bgm);
+    // Unloads the aliases, which must go before their sources
+    delete voicePool;
+    audio->unloadSound(collectSound);
+    audio->unloadSound(explodeSound);
+    audio->unloadMusic(bgm);
+    // The music stream reads from the pack mapping, so it goes last
+    delete assetPack;
 
-    CloseAudioDevice();
-    CloseWindow();
+    audio->close();
+    platform->closeWindow();
+
+    delete audio;
+    delete renderer;
+    delete platform;
 
     delete instance;
     instance = nullptr;
 }
 
-void GameManager::changeState(GameState* state) {
-    if (currentState != nullptr) {
-        delete currentState;
+// Both must be called straight after initialize(), before the first update,
+// so the recorded seed covers every random value of the session.
+bool GameManager::startRecording(const char* path) {
+    replayRecorder = new ReplayRecorder();
+    return replayRecorder->open(path, randomSeed, objectFactory->getSpawnTable().getHash());
+}
+
+bool GameManager::startPlayback(const char* path) {
+    replayPlayer = new ReplayPlayer();
+    if (!replayPlayer->open(path)) {
+        return false;
+    }
+    if (replayPlayer->getSpawnTableHash() != objectFactory->getSpawnTable().getHash()) {
+        fprintf(stderr, "replay: %s was recorded with a different spawn table and will not play back the same\n", path);
+    }
+    setRandomSeed(replayPlayer->getSeed());
+    replayFinished.store(replayPlayer->isFinished());
+    return true;
+}
+
+void GameManager::setJobThreads(int threads) {
+    jobThreads = threads;
+    if (platform == nullptr) {
+        return;
+    }
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
     }
-    currentState = state;
+    threads = threads < MAX_JOB_THREADS ? threads : MAX_JOB_THREADS;
+    delete jobSystem;
+    jobSystem = new JobSystem(threads);
+}
+
+void GameManager::setRandomSeed(unsigned int seed) {
+    randomSeed = seed;
+    for (int i = 0; i < static_cast<int>(RandomStream::COUNT); i++) {
+        randomStreams[i].seed(seed, (uint64_t)i);
+    }
+}
+
+bool GameManager::isReplayFinished() const {
+    return replayFinished.load();
+}
+
+void GameManager::changeState(StateId next) {
+    pendingState = next;
+}
+
+// Runs between ticks, when no state is inside its own update. Doing it per
+// tick rather than per frame keeps transitions on the same tick however
+// many ticks a frame runs, so replays are unaffected.
+void GameManager::applyPendingState() {
+    if (pendingState == StateId::NONE) {
+        return;
+    }
+    StateId from = StateId::NONE;
     if (currentState != nullptr) {
-        currentState->enter();
+        from = currentState->getId();
+        currentState->exit();
     }
+    currentState = states[static_cast<int>(pendingState)];
+    pendingState = StateId::NONE;
+    eventBus->publish(StateChangeEvent{ from, currentState->getId() });
+    currentState->enter();
 }
 
 void GameManager::triggerScreenFlash(float duration, Color color) {
@@ -138,28 +788,55 @@ void GameManager::updateScreenFlash(float deltaTime) {
     }
 }
 
+// Event listeners run wherever the simulation does, so these only count
 void GameManager::playCollectSound() {
-    PlaySound(collectSound);
+    collectTriggers.fetch_add(1);
 }
 
 void GameManager::playExplosionSound() {
-    PlaySound(explodeSound);
+    explosionTriggers.fetch_add(1);
 }
 
+// Every trigger still goes through play(), so the per-frame limits and
+// dropped counts are the same as playing them straight away
+void GameManager::playQueuedSounds() {
+    voicePool->beginFrame();
+    for (unsigned int i = collectTriggers.exchange(0); i > 0; i--) {
+        voicePool->play(SoundEffect::COLLECT);
+    }
+    for (unsigned int i = explosionTriggers.exchange(0); i > 0; i--) {
+        voicePool->play(SoundEffect::EXPLOSION);
+    }
+}
+
+// Counting starts lets a stop followed by a start within one frame still
+// restart the track
 void GameManager::startBackgroundMusic() {
-    if (!IsMusicStreamPlaying(bgm)) {
-        PlayMusicStream(bgm);
+    if (!musicWanted.exchange(true)) {
+        musicStarts.fetch_add(1);
     }
 }
 
 void GameManager::stopBackgroundMusic() {
-    if (IsMusicStreamPlaying(bgm)) {
-        StopMusicStream(bgm);
-    }
+    musicWanted.store(false);
 }
 
 bool GameManager::isMusicPlaying() const {
-    return IsMusicStreamPlaying(bgm);
+    return musicWanted.load();
+}
+
+void GameManager::updateBackgroundMusic() {
+    PROFILE_SCOPE("UpdateMusicStream");
+    unsigned int starts = musicStarts.load();
+    if (starts != musicStartsApplied) {
+        musicStartsApplied = starts;
+        audio->stopMusic(bgm);
+        audio->playMusic(bgm);
+    }
+    if (!musicWanted.load() && audio->isMusicPlaying(bgm)) {
+        audio->stopMusic(bgm);
+    }
+    audio->updateMusic(bgm);
 }
 
 void GameManager::updateSpawnTimer(float deltaTime) {
@@ -168,7 +845,7 @@ void GameManager::updateSpawnTimer(float deltaTime) {
 
 void GameManager::resetSpawnTimer() {
     spawnTimer = 0.0f;
-    spawnInterval = GetRandomValue(50, 200) / 100.0f;
+    spawnInterval = objectFactory->getSpawnTable().drawInterval(getRandom(RandomStream::SPAWN_TIMING).next());
 }
 
 bool GameManager::shouldSpawnObject() const {
@@ -1,33 +1,122 @@
 #pragma once
 #include "raylib.h"
+#include "Random.h"
+#include "GameEvents.h"
+#include "Renderer.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <vector>
 #include <string>
 
 class GameState;
+class Platform;
+class AudioDevice;
 class InputHandler;
 class ScoreSystem;
 class ObjectFactory;
+class BroadPhase;
+class EventBus;
+class VoicePool;
+class JobSystem;
+class ResolutionScaler;
+class Leaderboard;
+class FramePacer;
+enum class PacingPolicy;
+class TextureAtlas;
+class SpriteBatch;
+class TextLayoutCache;
+class ReplayRecorder;
+class AssetLoader;
+class AssetPack;
+enum class AssetId;
+struct PendingAssets;
+class ReplayPlayer;
 class Player;
+struct RenderSnapshot;
+template <typename T> class TripleBuffer;
 
 class GameManager {
 private:
     GameManager();
+    void queueAsset(AssetId id);
+    void simulate(float frameTime);
+    void runSimulation();
+    void updateBackgroundMusic();
+    void playQueuedSounds();
+    void setSuspended(bool suspend);
+    bool isFrameUnchanged(const RenderSnapshot& snapshot, unsigned long long staticKey) const;
+    void applyFramePacing();
+    void sampleInput();
 
     static GameManager* instance;
 
+    Platform* platform;
+    Renderer* renderer;
+    AudioDevice* audio;
+    ResolutionScaler* resolutionScaler;
+    // 0 lets resolutionScaler pick the scale
+    float fixedResolutionScale;
+    FramePacer* framePacer;
+    PacingPolicy pacingPolicy;
+    int pacingRate;
+    bool lowLatency;
+    // The input time of the last snapshot whose latency was recorded, so a
+    // snapshot presented twice counts once
+    std::chrono::steady_clock::time_point measuredInput;
+
+    // Every state is created once in initialize() and reused
+    GameState* states[static_cast<int>(StateId::COUNT)];
     GameState* currentState;
+    StateId pendingState;
     InputHandler* inputHandler;
     ScoreSystem* scoreSystem;
     ObjectFactory* objectFactory;
+    BroadPhase* broadPhase;
+    EventBus* eventBus;
+    JobSystem* jobSystem;
+    int jobThreads;
     Player* player;
 
+    AssetLoader* assetLoader;
+    AssetPack* assetPack;
+    PendingAssets* pendingAssets;
+    bool assetsReady;
+    double startupMs;
+
     Font pixelFont;
-    Texture2D background;
-    Texture2D railLeft, railMid, railRight;
+    TextureAtlas* atlas;
+    SpriteBatch* spriteBatch;
+    TextLayoutCache* textCache;
 
     Music bgm;
     Sound collectSound;
     Sound explodeSound;
+    VoicePool* voicePool;
+
+    // render() only reads these; the simulation fills one after its ticks
+    TripleBuffer<RenderSnapshot>* snapshots;
+    bool threadedSimulation;
+    std::thread simulationThread;
+    std::atomic<bool> simulationRunning;
+    std::atomic<bool> simulationPaused;
+
+    // One cached background layer per state, see GameState::renderStatic()
+    RenderLayer stateLayers[static_cast<int>(StateId::COUNT)];
+    // The still screen the window shows, or NONE after a frame that moved
+    StateId presentedState;
+    unsigned long long presentedKey;
+    bool suspended;
+
+    // States ask for music from the simulation side, but the stream is only
+    // ever touched on the main thread
+    std::atomic<bool> musicWanted;
+    std::atomic<unsigned int> musicStarts;
+    unsigned int musicStartsApplied;
+    // Sound effects too: events only count triggers, and the main thread
+    // plays them through the voice pool
+    std::atomic<unsigned int> collectTriggers;
+    std::atomic<unsigned int> explosionTriggers;
 
     bool screenFlash;
     float flashAlpha;
@@ -35,37 +124,119 @@ private:
 
     int screenWidth;
     int screenHeight;
+    size_t objectCapacity;
+    std::string spawnTablePath;
+    Leaderboard* leaderboard;
+    std::string leaderboardPath;
 
     float spawnTimer;
     float spawnInterval;
 
+    // The last frame time advance() was given, for render()
+    float lastFrameTime;
+    // Where the running tick ends on Platform::getTime()'s clock; input
+    // events up to here belong to it
+    double tickEndTime;
+    float simulationStep;
+    float accumulator;
+    float interpolationAlpha;
+    float timeScale;
+    bool lockstep;
+
+    unsigned int randomSeed;
+    Random randomStreams[static_cast<int>(RandomStream::COUNT)];
+    ReplayRecorder* replayRecorder;
+    ReplayPlayer* replayPlayer;
+    std::atomic<bool> replayFinished;
+
 public:
     GameManager(const GameManager&) = delete;
     GameManager& operator=(const GameManager&) = delete;
 
     static GameManager* getInstance();
 
- 
-    void initialize();
+    void setObjectCapacity(size_t capacity) { objectCapacity = capacity; }
+    // Threads for parallel object updates, counting the main thread; 0 uses
+    // every core. Takes effect immediately, or at initialize().
+    void setJobThreads(int threads);
+    void setSpawnTablePath(const char* path) { spawnTablePath = path; }
+    // Where finished runs are kept; empty, the default, keeps none. Call
+    // before initialize(), which loads the best score as the high score.
+    void setLeaderboardPath(const char* path) { leaderboardPath = path; }
+    void setSimulationRate(int hz) { simulationStep = 1.0f / hz; }
+    void setTimeScale(float scale) { timeScale = scale; }
+    void setLockstep(bool enabled) { lockstep = enabled; }
+    // Pins the fraction of the window's resolution the scene is rendered at;
+    // 0 adjusts it to the frame time budget
+    void setResolutionScale(float scale) { fixedResolutionScale = scale; }
+    // rate caps the frame rate for CAP and is ignored otherwise; lowLatency
+    // starts frames as late as still makes their present. The headless
+    // backend always runs uncapped. Takes effect immediately, or at initialize().
+    void setFramePacing(PacingPolicy policy, int rate, bool lowLatency);
+    const FramePacer* getFramePacer() const { return framePacer; }
+    // Call at the top of each frame, before reading the frame time
+    void waitForFrame();
+    // Once the assets are in, ticks run on a thread of their own and the main
+    // thread only polls input, streams music and renders. Call before
+    // initialize(); not for the headless backend.
+    void setThreadedSimulation(bool enabled) { threadedSimulation = enabled; }
+    bool isSimulationThreaded() const { return simulationThread.joinable(); }
+    // Joins the simulation thread, after which everything is safe to read
+    // from the main thread again
+    void stopSimulationThread();
+    void initialize(bool headless = false);
+    void advance(float frameTime);
     void update(float deltaTime);
     void render();
+    // Copies the simulation's current state out for render(). advance()
+    // does this after its ticks; anything else driving update() calls it itself.
+    void publishSnapshot(float alpha);
+    const RenderSnapshot& acquireSnapshot();
 
     void cleanup();
 
-    void changeState(GameState* state);
+    void finishLoading();
+    bool areAssetsReady() const { return assetsReady; }
+    AssetLoader* getAssetLoader() const { return assetLoader; }
+    double getStartupMs() const { return startupMs; }
+
+    bool startRecording(const char* path);
+    bool startPlayback(const char* path);
+    bool isReplayFinished() const;
+    ReplayPlayer* getReplayPlayer() const { return replayPlayer; }
+    // Reseeds every stream. Like startRecording, call it before the first update.
+    void setRandomSeed(unsigned int seed);
+    unsigned int getRandomSeed() const { return randomSeed; }
+    Random& getRandom(RandomStream stream) { return randomStreams[static_cast<int>(stream)]; }
+
+    // Queues a transition. It happens once the running state's update has
+    // returned, at the end of the tick: exit() on the old state, then enter()
+    // on the new one.
+    void changeState(StateId next);
+    void applyPendingState();
 
     int getScreenWidth() const { return screenWidth; }
     int getScreenHeight() const { return screenHeight; }
+    Platform* getPlatform() const { return platform; }
+    Renderer* getRenderer() const { return renderer; }
+    AudioDevice* getAudio() const { return audio; }
+    VoicePool* getVoicePool() const { return voicePool; }
     GameState* getCurrentState() const { return currentState; }
+    GameState* getState(StateId id) const { return states[static_cast<int>(id)]; }
     InputHandler* getInputHandler() const { return inputHandler; }
     ScoreSystem* getScoreSystem() const { return scoreSystem; }
     ObjectFactory* getObjectFactory() const { return objectFactory; }
+    BroadPhase* getBroadPhase() const { return broadPhase; }
+    EventBus* getEventBus() const { return eventBus; }
+    JobSystem* getJobSystem() const { return jobSystem; }
+    Leaderboard* getLeaderboard() const { return leaderboard; }
     Player* getPlayer() const { return player; }
     Font getFont() const { return pixelFont; }
-    Texture2D getBackground() const { return background; }
-    Texture2D getRailLeft() const { return railLeft; }
-    Texture2D getRailMid() const { return railMid; }
-    Texture2D getRailRight() const { return railRight; }
+    const TextureAtlas* getAtlas() const { return atlas; }
+    SpriteBatch* getSpriteBatch() const { return spriteBatch; }
+    TextLayoutCache* getTextCache() const { return textCache; }
+    float getSimulationStep() const { return simulationStep; }
+    float getInterpolationAlpha() const { return interpolationAlpha; }
 
     void triggerScreenFlash(float duration, Color color);
     void updateScreenFlash(float deltaTime);
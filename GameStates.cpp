@@ -4,16 +4,58 @@
 #include "ScoreSystem.h"
 #include "Player.h"
 #include "InputHandler.h"
+#include "Renderer.h"
+#include "BroadPhase.h"
+#include "GameEvents.h"
+#include "JobSystem.h"
+#include "MotionKernels.h"
+#include "SpriteBatch.h"
+#include "TextLayout.h"
+#include "AssetLoader.h"
+#include "RenderSnapshot.h"
+#include "Profiler.h"
 #include <algorithm>
+#include <ctime>
 
 
 void GameState::drawCenteredText(const std::string& text, float y, float fontSize, Color color) {
     GameManager* gm = GameManager::getInstance();
     Font font = gm->getFont();
-    float textWidth = MeasureTextEx(font, text.c_str(), fontSize, 1).x;
-    DrawTextEx(font, text.c_str(),
-        Vector2{ gm->getScreenWidth() / 2.0f - textWidth / 2, y },
-        fontSize, 1, color);
+    const TextLayout& layout = gm->getTextCache()->get(font, text.c_str(), fontSize, 1);
+    gm->getRenderer()->drawTextLayout(font, layout,
+        Vector2{ gm->getScreenWidth() / 2.0f - layout.width / 2, y }, color);
+}
+
+void LoadingState::enter() {
+}
+
+void LoadingState::update(float deltaTime) {
+    PROFILE_SCOPE("LoadingState::update");
+    GameManager* gm = GameManager::getInstance();
+    AssetLoader* loader = gm->getAssetLoader();
+    loader->pump();
+    if (loader->isDone()) {
+        gm->finishLoading();
+        gm->changeState(StateId::TITLE);
+    }
+}
+
+void LoadingState::render(const RenderSnapshot&) {
+    PROFILE_SCOPE("LoadingState::render");
+    GameManager* gm = GameManager::getInstance();
+    Renderer* renderer = gm->getRenderer();
+    AssetLoader* loader = gm->getAssetLoader();
+    float progress = loader != nullptr ? loader->getProgress() : 1.0f;
+
+    int barWidth = gm->getScreenWidth() / 2;
+    int barX = (gm->getScreenWidth() - barWidth) / 2;
+    int barY = gm->getScreenHeight() / 2 + 20;
+    drawCenteredText("Loading...", gm->getScreenHeight() / 2 - 20, 20, DARKGRAY);
+    renderer->drawRectangle(barX, barY, barWidth, 10, LIGHTGRAY);
+    renderer->drawRectangle(barX, barY, (int)(barWidth * progress), 10, SKYBLUE);
+}
+
+void LoadingState::exit() {
 }
 
 void TitleState::enter() {
@@ -22,25 +64,34 @@ void TitleState::enter() {
 }
 
 void TitleState::update(float deltaTime) {
+    PROFILE_SCOPE("TitleState::update");
     GameManager* gm = GameManager::getInstance();
     InputHandler* input = gm->getInputHandler();
 
-    if (input->isKeyPressed(KEY_ENTER)) {
-        gm->changeState(new GameplayState());
+    if (input->isStartPressed()) {
+        gm->changeState(StateId::GAMEPLAY);
     }
 }
 
-void TitleState::render() {
+// The whole screen is in the static layer
+void TitleState::render(const RenderSnapshot&) {
+}
+
+unsigned long long TitleState::getStaticKey(const RenderSnapshot& snapshot) const {
+    return (unsigned int)snapshot.score.highScore;
+}
+
+void TitleState::renderStatic(const RenderSnapshot& snapshot) {
+    PROFILE_SCOPE("TitleState::renderStatic");
     GameManager* gm = GameManager::getInstance();
-    ScoreSystem* scoreSystem = gm->getScoreSystem();
 
     drawCenteredText("COLLECT D'GEMS", gm->getScreenHeight() / 3, 40, SKYBLUE);
     drawCenteredText("Press ENTER to Start", gm->getScreenHeight() / 2, 20, LIGHTGRAY);
     drawCenteredText("Use LEFT and RIGHT arrows Or A and D to move", gm->getScreenHeight() / 2 + 40, 20, LIGHTGRAY);
     drawCenteredText("Avoid the Dynamites!", gm->getScreenHeight() / 2 + 70, 20, RED);
 
-    if (scoreSystem->getHighScore() > 0) {
-        drawCenteredText(TextFormat("High Score: %d", scoreSystem->getHighScore()),
+    if (snapshot.score.highScore > 0) {
+        drawCenteredText(TextFormat("High Score: %d", snapshot.score.highScore),
             gm->getScreenHeight() / 2 + 120, 20, GOLD);
     }
 }
@@ -51,105 +102,205 @@ void TitleState::exit() {
     gm->startBackgroundMusic();
 }
 
+// The scratch buffers cover a full pool, so no game ever allocates. The job
+// system only ever makes chunks larger than CHUNK_SIZE, never more of them.
+GameplayState::GameplayState(size_t maxObjects) :
+    hits(maxObjects),
+    chunkHits(maxObjects / CHUNK_SIZE + 1),
+    runActive(false),
+    runTime(0.0f),
+    runGems()
+{
+}
+
 void GameplayState::enter() {
     GameManager* gm = GameManager::getInstance();
     ScoreSystem* scoreSystem = gm->getScoreSystem();
 
     scoreSystem->resetScore();
-    objects.clear();
+    gm->getObjectFactory()->releaseAll();
     Player* player = gm->getPlayer();
     player->setPosition(Vector2{ gm->getScreenWidth() / 2.0f, player->getPosition().y });
 
     gm->resetSpawnTimer();
+    runActive = true;
+    runTime = 0.0f;
+    for (uint32_t& gems : runGems) {
+        gems = 0;
+    }
     if (!gm->isMusicPlaying()) {
         gm->startBackgroundMusic();
     }
 }
 
 void GameplayState::update(float deltaTime) {
+    PROFILE_SCOPE("GameplayState::update");
     GameManager* gm = GameManager::getInstance();
     InputHandler* input = gm->getInputHandler();
     Player* player = gm->getPlayer();
     ScoreSystem* scoreSystem = gm->getScoreSystem();
     ObjectFactory* factory = gm->getObjectFactory();
+    EventBus* events = gm->getEventBus();
 
+    runTime += deltaTime;
+    player->savePreviousPosition();
     input->handleInput(player, deltaTime);
     player->update(deltaTime);
     scoreSystem->update(deltaTime);
     gm->updateSpawnTimer(deltaTime);
     if (gm->shouldSpawnObject()) {
-        FallingObject* newObject = factory->createObject();
-        addObject(newObject);
+        ObjectHandle spawned[SpawnTable::MAX_BURST];
+        size_t count = factory->createObjects(factory->getSpawnTable().getBurst(), spawned);
+        for (size_t i = 0; i < count; i++) {
+            size_t index = factory->getPool().indexOf(spawned[i]);
+            events->publish(SpawnEvent{ factory->getPool().getType(index), factory->getPool().getPosition(index) });
+        }
         gm->resetSpawnTimer();
     }
 
-    for (auto object : objects) {
-        if (object->isActive()) {
-            object->update(deltaTime);
-            if (object->checkCollision(player->getHitbox())) {
-
-                if (object->getType() == ObjectType::DYNAMITE) {
-                    gm->playExplosionSound();
-                    gm->triggerScreenFlash(1.0f, RED);
-                    player->setHit(true);
-                    gm->changeState(new GameOverState());
-                    object->setActive(false);
-                    return;
-                }
-                else {
-                    gm->playCollectSound();
-                    scoreSystem->addScore(object->getScore(), object->getPosition(), object->getScoreColor());
-                }
-                object->setActive(false);
+    FallingObjectPool& objects = factory->getPool();
+    size_t hitCount = updateObjects(deltaTime, player->getHitbox());
+
+    // Hits come back in ascending index order however the update was split,
+    // so scores and the dynamite check always land in the same order
+    for (size_t h = 0; h < hitCount; h++) {
+        size_t i = hits[h];
+        if (objects.getType(i) == ObjectType::DYNAMITE) {
+            events->publish(ExplosionEvent{ objects.getPosition(i) });
+            gm->triggerScreenFlash(1.0f, RED);
+            player->setHit(true);
+            endRun(RunEnd::DYNAMITE);
+            gm->changeState(StateId::GAME_OVER);
+            objects.setActive(i, false);
+            return;
+        }
+        else {
+            Color color = factory->getSpawnTable().getEntry(objects.getType(i)).color;
+            scoreSystem->addScore(objects.getScore(i), objects.getPosition(i), color);
+            int type = static_cast<int>(objects.getType(i));
+            if (type < GEM_TYPE_COUNT) {
+                runGems[type]++;
             }
+            events->publish(GemCollectedEvent{ objects.getType(i), objects.getScore(i), objects.getPosition(i) });
         }
+        objects.setActive(i, false);
     }
     cleanupInactiveObjects();
 }
 
-void GameplayState::render() {
+// Moves every object one tick and collects the ones now touching the cart
+// into hits. Large pools are split into chunks for the job system; each
+// chunk records its hits in its own slice of the buffer, and the slices are
+// then packed in chunk order, which keeps the result independent of how the
+// chunks were scheduled.
+size_t GameplayState::updateObjects(float deltaTime, Rectangle hitbox) {
     GameManager* gm = GameManager::getInstance();
-    ScoreSystem* scoreSystem = gm->getScoreSystem();
-    Player* player = gm->getPlayer();
+    FallingObjectPool& objects = gm->getObjectFactory()->getPool();
+    JobSystem* jobs = gm->getJobSystem();
 
-    int trackY = gm->getScreenHeight() - gm->getRailMid().height;
-    int x = 0;
-    DrawTexture(gm->getRailLeft(), x, trackY, WHITE);
-    x += gm->getRailLeft().width;
-    while (x + gm->getRailRight().width < gm->getScreenWidth()) {
-        DrawTexture(gm->getRailMid(), x, trackY, WHITE);
-        x += gm->getRailMid().width;
+    size_t count = objects.size();
+    if (count == 0) {
+        return 0;
     }
-    DrawTexture(gm->getRailRight(), gm->getScreenWidth() - gm->getRailRight().width, trackY, WHITE);
+    size_t chunkCount = jobs->getChunkCount(count, CHUNK_SIZE);
 
-    for (auto object : objects) {
-        if (object->isActive()) {
-            object->render();
-        }
+    const MotionKernels& kernels = getMotionKernels();
+    MotionArrays motion = objects.getMotion();
+    float screenBottom = (float)gm->getScreenHeight();
+    BroadPhase* broadPhase = gm->getBroadPhase();
+    broadPhase->begin(hitbox, objects.getMaxSize());
+    uint32_t* slots = hits.data();
+    ChunkHits* results = chunkHits.data();
+    auto updateChunk = [&kernels, &motion, broadPhase, slots, results, deltaTime, screenBottom](size_t chunk, size_t begin, size_t end) {
+        PROFILE_SCOPE("GameplayState::updateChunk");
+        kernels.integrate(motion, begin, end, deltaTime, screenBottom);
+        size_t candidates = 0;
+        size_t found = broadPhase->collide(kernels, motion, begin, end, slots + begin, candidates);
+        results[chunk] = ChunkHits{ (uint32_t)begin, (uint32_t)found, (uint32_t)candidates };
+    };
+    if (jobs->getThreadCount() > 1 && count >= PARALLEL_THRESHOLD) {
+        jobs->parallelFor(count, CHUNK_SIZE, updateChunk);
+    }
+    else {
+        chunkCount = 1;
+        updateChunk(0, 0, count);
     }
-    player->render();
-    scoreSystem->render();
+
+    // Slices only move towards the front, so packing in place is safe
+    size_t total = 0;
+    size_t candidates = 0;
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        std::copy(slots + results[chunk].begin, slots + results[chunk].begin + results[chunk].count, slots + total);
+        total += results[chunk].count;
+        candidates += results[chunk].candidates;
+    }
+    broadPhase->record(count, candidates);
+    return total;
 }
 
-void GameplayState::exit() {
-    for (auto object : objects) {
-        delete object;
+void GameplayState::renderStatic(const RenderSnapshot&) {
+    PROFILE_SCOPE("GameplayState::renderStatic");
+    GameManager* gm = GameManager::getInstance();
+    const TextureAtlas* atlas = gm->getAtlas();
+    SpriteBatch* batch = gm->getSpriteBatch();
+
+    int railLeftWidth = atlas->getWidth(SpriteId::RAIL_LEFT);
+    int railMidWidth = atlas->getWidth(SpriteId::RAIL_MID);
+    int railRightWidth = atlas->getWidth(SpriteId::RAIL_RIGHT);
+    float trackY = (float)(gm->getScreenHeight() - atlas->getHeight(SpriteId::RAIL_MID));
+    int x = 0;
+    batch->draw(SpriteId::RAIL_LEFT, (float)x, trackY, WHITE);
+    x += railLeftWidth;
+    while (x + railRightWidth < gm->getScreenWidth()) {
+        batch->draw(SpriteId::RAIL_MID, (float)x, trackY, WHITE);
+        x += railMidWidth;
     }
-    objects.clear();
+    batch->draw(SpriteId::RAIL_RIGHT, (float)(gm->getScreenWidth() - railRightWidth), trackY, WHITE);
 }
 
-void GameplayState::addObject(FallingObject* object) {
-    objects.push_back(object);
+void GameplayState::render(const RenderSnapshot& snapshot) {
+    PROFILE_SCOPE("GameplayState::render");
+    GameManager* gm = GameManager::getInstance();
+    SpriteBatch* batch = gm->getSpriteBatch();
+
+    float alpha = gm->getInterpolationAlpha();
+    FallingObjectPool::render(*batch, snapshot.objects, alpha);
+    snapshot.player.render(*batch, alpha);
+    batch->flush();
+    gm->getScoreSystem()->render(snapshot.score, alpha);
+}
+
+void GameplayState::exit() {
+    GameManager::getInstance()->getObjectFactory()->releaseAll();
+}
+
+void GameplayState::endRun(RunEnd cause) {
+    if (!runActive) {
+        return;
+    }
+    runActive = false;
+    GameManager* gm = GameManager::getInstance();
+    RunRecord record = {};
+    record.endedAt = (int64_t)time(NULL);
+    record.score = gm->getScoreSystem()->getScore();
+    record.duration = runTime;
+    for (int i = 0; i < GEM_TYPE_COUNT; i++) {
+        record.gems[i] = runGems[i];
+    }
+    record.cause = cause;
+    gm->getLeaderboard()->submit(record);
 }
 
 void GameplayState::cleanupInactiveObjects() {
-    for (auto it = objects.begin(); it != objects.end();) {
-        if (!(*it)->isActive()) {
-            delete* it;
-            it = objects.erase(it);
+    PROFILE_SCOPE("GameplayState::cleanupInactiveObjects");
+    FallingObjectPool& objects = GameManager::getInstance()->getObjectFactory()->getPool();
+    size_t i = 0;
+    while (i < objects.size()) {
+        if (!objects.isActive(i)) {
+            objects.releaseAt(i);
         }
         else {
-            ++it;
+            i++;
         }
     }
 }
@@ -160,23 +311,32 @@ void GameOverState::enter() {
 }
 
 void GameOverState::update(float deltaTime) {
+    PROFILE_SCOPE("GameOverState::update");
     GameManager* gm = GameManager::getInstance();
     InputHandler* input = gm->getInputHandler();
 
-    if (input->isKeyPressed(KEY_ENTER)) {
-        gm->changeState(new GameplayState());
+    if (input->isStartPressed()) {
+        gm->changeState(StateId::GAMEPLAY);
     }
 }
 
-void GameOverState::render() {
+// The whole screen is in the static layer
+void GameOverState::render(const RenderSnapshot&) {
+}
+
+unsigned long long GameOverState::getStaticKey(const RenderSnapshot& snapshot) const {
+    return (unsigned long long)(unsigned int)snapshot.score.score << 32 | (unsigned int)snapshot.score.highScore;
+}
+
+void GameOverState::renderStatic(const RenderSnapshot& snapshot) {
+    PROFILE_SCOPE("GameOverState::renderStatic");
     GameManager* gm = GameManager::getInstance();
-    ScoreSystem* scoreSystem = gm->getScoreSystem();
 
     drawCenteredText("GAME OVER!", gm->getScreenHeight() / 3, 40, RED);
-    drawCenteredText(TextFormat("Final Score: %d", scoreSystem->getScore()),
+    drawCenteredText(TextFormat("Final Score: %d", snapshot.score.score),
         gm->getScreenHeight() / 2 - 20, 30, BLACK);
 
-    if (scoreSystem->getScore() >= scoreSystem->getHighScore()) {
+    if (snapshot.score.score >= snapshot.score.highScore) {
         drawCenteredText("NEW HIGH SCORE!", gm->getScreenHeight() / 2 + 20, 20, GOLD);
     }
     drawCenteredText("Press ENTER to Play Again", gm->getScreenHeight() / 2 + 60, 20, DARKGRAY);
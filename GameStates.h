@@ -1,47 +1,109 @@
 #pragma once
 #include "raylib.h"
+#include "GameEvents.h"
+#include "Leaderboard.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 
+struct RenderSnapshot;
+
+// update() runs on the simulation side and owns the game objects; render()
+// only draws the snapshot it is handed.
 class GameState {
 public:
     virtual ~GameState() {}
 
     virtual void enter() = 0;
     virtual void update(float deltaTime) = 0;
-    virtual void render() = 0;
+    virtual void render(const RenderSnapshot& snapshot) = 0;
     virtual void exit() = 0;
+    virtual StateId getId() const = 0;
+
+    // Drawn over the background into a cached layer, and only drawn again
+    // when getStaticKey() changes. render() draws on top of it every frame.
+    virtual void renderStatic(const RenderSnapshot& snapshot) {}
+    virtual unsigned long long getStaticKey(const RenderSnapshot& snapshot) const { return 0; }
+    // False when render() draws nothing that moves, so a frame that would
+    // look the same as the last one can be skipped
+    virtual bool isAnimated() const { return true; }
 
     void drawCenteredText(const std::string& text, float y, float fontSize, Color color);
 };
 
+// Shown while AssetLoader works. Only the raylib default font is available.
+class LoadingState : public GameState {
+public:
+    void enter() override;
+    void update(float deltaTime) override;
+    void render(const RenderSnapshot& snapshot) override;
+    void exit() override;
+    StateId getId() const override { return StateId::LOADING; }
+};
+
 class TitleState : public GameState {
 public:
     void enter() override;
     void update(float deltaTime) override;
-    void render() override;
+    void render(const RenderSnapshot& snapshot) override;
     void exit() override;
+    StateId getId() const override { return StateId::TITLE; }
+
+    void renderStatic(const RenderSnapshot& snapshot) override;
+    unsigned long long getStaticKey(const RenderSnapshot& snapshot) const override;
+    bool isAnimated() const override { return false; }
 };
 
 class GameplayState : public GameState {
 private:
-    std::vector<class FallingObject*> objects;
+    struct ChunkHits {
+        uint32_t begin;
+        uint32_t count;
+        uint32_t candidates;
+    };
+
+    // Objects touching the cart this tick; each chunk of the update writes
+    // its broad phase candidates and then its hits into its own slice
+    std::vector<uint32_t> hits;
+    std::vector<ChunkHits> chunkHits;
+
+    // The run in progress, for the leaderboard
+    bool runActive;
+    float runTime;
+    uint32_t runGems[GEM_TYPE_COUNT];
+
+    size_t updateObjects(float deltaTime, Rectangle hitbox);
 
 public:
+    // Below this many objects waking the workers costs more than it saves
+    static const size_t PARALLEL_THRESHOLD = 4096;
+    static const size_t CHUNK_SIZE = 1024;
+
+    explicit GameplayState(size_t maxObjects);
+
     void enter() override;
     void update(float deltaTime) override;
-    void render() override;
+    void render(const RenderSnapshot& snapshot) override;
     void exit() override;
+    StateId getId() const override { return StateId::GAMEPLAY; }
 
-    void addObject(class FallingObject* object);
+    void renderStatic(const RenderSnapshot& snapshot) override;
 
     void cleanupInactiveObjects();
+    // Hands the run in progress to the leaderboard. Only the first call
+    // after enter() counts.
+    void endRun(RunEnd cause);
 };
 
 class GameOverState : public GameState {
 public:
     void enter() override;
     void update(float deltaTime) override;
-    void render() override;
+    void render(const RenderSnapshot& snapshot) override;
     void exit() override;
+    StateId getId() const override { return StateId::GAME_OVER; }
+
+    void renderStatic(const RenderSnapshot& snapshot) override;
+    unsigned long long getStaticKey(const RenderSnapshot& snapshot) const override;
+    bool isAnimated() const override { return false; }
 };
\ No newline at end of file
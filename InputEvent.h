@@ -0,0 +1,64 @@
+#pragma once
+#include "RingBuffer.h"
+#include <cstdint>
+#include <mutex>
+
+enum class InputKey : uint8_t {
+    LEFT,
+    RIGHT,
+    ENTER,
+    COUNT
+};
+
+// One key going down or up
+struct InputEvent {
+    // Seconds on Platform::getTime()'s clock
+    double time;
+    // steady_clock ticks when the game first saw it, for latency stats
+    long long observedAt;
+    InputKey key;
+    bool down;
+};
+
+// Key events waiting for the tick whose span they fall in. Pushed on the
+// main thread and popped by the simulation, which may have its own thread.
+// A full queue drops its oldest event.
+class InputEventQueue {
+private:
+    mutable std::mutex mutex;
+    RingBuffer<InputEvent> events;
+
+public:
+    explicit InputEventQueue(size_t maxEvents) : events(maxEvents) {}
+
+    void push(const InputEvent& event);
+    // Pops the oldest event if it happened at or before time
+    bool popUntil(double time, InputEvent& event);
+    void clear();
+    bool isEmpty() const;
+};
+
+inline void InputEventQueue::push(const InputEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.push(event);
+}
+
+inline bool InputEventQueue::popUntil(double time, InputEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (events.isEmpty() || events.front().time > time) {
+        return false;
+    }
+    event = events.front();
+    events.popFront();
+    return true;
+}
+
+inline void InputEventQueue::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.clear();
+}
+
+inline bool InputEventQueue::isEmpty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return events.isEmpty();
+}
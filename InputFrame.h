@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+
+// Everything the simulation reads from the keyboard in one tick. Key events
+// are folded into one of these per tick, so a recorded stream of frames
+// drives the game exactly like the live keyboard did.
+struct InputFrame {
+    static const uint16_t WHOLE_TICK = 65535;
+
+    // How much of the tick each direction key was down, in 65535ths
+    uint16_t left;
+    uint16_t right;
+    // ENTER went down during the tick
+    bool enter;
+
+    static float toFraction(uint16_t held);
+};
+
+// Exactly 1 for a key held through the tick, so that case moves the cart
+// the same as scaling by nothing at all
+inline float InputFrame::toFraction(uint16_t held) {
+    return held == WHOLE_TICK ? 1.0f : held / (float)WHOLE_TICK;
+}
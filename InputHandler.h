@@ -1,8 +1,16 @@
 #pragma once
 #include "raylib.h"
+#include "InputFrame.h"
+#include "InputEvent.h"
+#include "Platform.h"
+#include <atomic>
+#include <chrono>
 
 class Player;
 
+// Longest hold poll() gives a press it only saw after its release
+static const double MAX_POLLED_TAP = 1.0 / 30.0;
+
 class Command {
 public:
     virtual ~Command() {}
@@ -19,15 +27,55 @@ public:
     void execute(Player* player, float deltaTime) override;
 };
 
-class InputHandler {
+// Turns key changes into per-tick InputFrames. Changes arrive as timestamped
+// events, from the platform's callback when it has one and otherwise from
+// poll(). Each tick folds in the events that fall inside its span of real
+// time, so a key held for part of a tick moves the cart for exactly that
+// part, and a press shorter than a frame still registers.
+class InputHandler : public KeyListener {
 private:
+    static const size_t MAX_EVENTS = 256;
+    static const int POLLED_KEY_COUNT = 5;
+
     Command* leftCommand;
     Command* rightCommand;
+    Platform* platform;
+    InputFrame frame;
+    InputEventQueue events;
+    bool platformEvents;
+
+    // Main thread: physical keys down per InputKey, since A and LEFT both
+    // steer left, and what poll() saw last time
+    uint8_t keysDown[static_cast<int>(InputKey::COUNT)];
+    bool polledDown[POLLED_KEY_COUNT];
+    double lastPollTime;
+    // InputKey bits currently down, read by hasPendingInput()
+    std::atomic<uint8_t> heldKeys;
+
+    // Simulation side: key state as of the last consumed event
+    bool tickDown[static_cast<int>(InputKey::COUNT)];
+    double lastTickEnd;
+    // The earliest event consumed since takeConsumedChange(), 0 for none
+    long long consumedChange;
+
+    static int toInputKey(int key);
 
 public:
-    InputHandler() {
+    InputHandler(Platform* platform) :
+        platform(platform),
+        events(MAX_EVENTS),
+        platformEvents(false),
+        keysDown(),
+        polledDown(),
+        lastPollTime(0.0),
+        heldKeys(0),
+        tickDown(),
+        lastTickEnd(0.0),
+        consumedChange(0)
+    {
         leftCommand = new MoveLeftCommand();
         rightCommand = new MoveRightCommand();
+        frame = InputFrame{ 0, 0, false };
     }
 
     ~InputHandler() {
@@ -35,10 +83,26 @@ public:
         delete rightCommand;
     }
 
+    // Asks the platform for key events. Until then, or if it has none,
+    // poll() compares key state from frame to frame instead.
+    void listen();
+    bool hasPlatformEvents() const { return platformEvents; }
+    void onKey(int key, bool down, double time) override;
+    void poll();
+    // Folds in the events up to tickEnd, on Platform::getTime()'s clock. The
+    // tick covers the tickLength seconds before that, or less if the previous
+    // tick ended later.
+    InputFrame consume(double tickEnd, double tickLength);
+    void setFrame(const InputFrame& newFrame) { frame = newFrame; }
+    const InputFrame& getFrame() const { return frame; }
+    // A key held or an event not yet consumed by a tick
+    bool hasPendingInput() const;
+    // When the oldest event the ticks since the last call acted on was first
+    // seen, or the clock's epoch if they acted on none
+    std::chrono::steady_clock::time_point takeConsumedChange();
+
     void handleInput(Player* player, float deltaTime);
-    bool isKeyPressed(int key) const {
-        return IsKeyPressed(key);
-    }
+    bool isStartPressed() const { return frame.enter; }
 };
 
 #include "Player.h"
@@ -51,12 +115,161 @@ inline void MoveRightCommand::execute(Player* player, float deltaTime) {
     player->moveRight(deltaTime);
 }
 
+inline int InputHandler::toInputKey(int key) {
+    switch (key) {
+    case KEY_LEFT:
+    case KEY_A:
+        return static_cast<int>(InputKey::LEFT);
+    case KEY_RIGHT:
+    case KEY_D:
+        return static_cast<int>(InputKey::RIGHT);
+    case KEY_ENTER:
+        return static_cast<int>(InputKey::ENTER);
+    default:
+        return -1;
+    }
+}
+
+inline void InputHandler::listen() {
+    events.clear();
+    platformEvents = platform->setKeyListener(this);
+}
+
+// Runs on the main thread, from the platform's callback or from poll()
+inline void InputHandler::onKey(int key, bool down, double time) {
+    int index = toInputKey(key);
+    if (index < 0) {
+        return;
+    }
+    uint8_t& count = keysDown[index];
+    bool wasDown = count > 0;
+    if (down) {
+        count++;
+    }
+    else if (count > 0) {
+        count--;
+    }
+    bool isDown = count > 0;
+    if (isDown == wasDown) {
+        return;
+    }
+    long long observedAt = std::chrono::steady_clock::now().time_since_epoch().count();
+    events.push(InputEvent{ time, observedAt, static_cast<InputKey>(index), isDown });
+    uint8_t bit = (uint8_t)(1 << index);
+    if (isDown) {
+        heldKeys.fetch_or(bit, std::memory_order_relaxed);
+    }
+    else {
+        heldKeys.fetch_and((uint8_t)~bit, std::memory_order_relaxed);
+    }
+}
+
+// Called once per displayed frame. Without platform events, a change is
+// timed at the poll that sees it. A press that is already over by then has
+// no timing left to measure, so it is taken as held since the previous poll,
+// up to MAX_POLLED_TAP. It moves the cart by that much rather than exactly
+// as far as the key was really held.
+inline void InputHandler::poll() {
+    if (platformEvents) {
+        return;
+    }
+    static const int polledKeys[POLLED_KEY_COUNT] = { KEY_LEFT, KEY_A, KEY_RIGHT, KEY_D, KEY_ENTER };
+    double now = platform->getTime();
+    double tapStart = now - MAX_POLLED_TAP > lastPollTime ? now - MAX_POLLED_TAP : lastPollTime;
+    bool down[POLLED_KEY_COUNT];
+    bool pressed[POLLED_KEY_COUNT];
+    // Taps go first, since events must be queued in time order
+    for (int i = 0; i < POLLED_KEY_COUNT; i++) {
+        down[i] = platform->isKeyDown(polledKeys[i]);
+        pressed[i] = platform->isKeyPressed(polledKeys[i]);
+        if (!polledDown[i] && !down[i] && pressed[i]) {
+            onKey(polledKeys[i], true, tapStart);
+        }
+    }
+    for (int i = 0; i < POLLED_KEY_COUNT; i++) {
+        if (!polledDown[i] && down[i]) {
+            onKey(polledKeys[i], true, now);
+        }
+        if ((polledDown[i] || pressed[i]) && !down[i]) {
+            onKey(polledKeys[i], false, now);
+        }
+        polledDown[i] = down[i];
+    }
+    lastPollTime = now;
+}
+
+// Called once per simulation tick. Held time is measured per key between
+// its events and quantized once, so the result only depends on the events
+// and the tick's span.
+inline InputFrame InputHandler::consume(double tickEnd, double tickLength) {
+    double tickStart = tickEnd - tickLength;
+    if (tickStart < lastTickEnd) {
+        tickStart = lastTickEnd;
+    }
+    if (tickStart > tickEnd) {
+        tickStart = tickEnd;
+    }
+    lastTickEnd = tickEnd;
+
+    const int keyCount = static_cast<int>(InputKey::COUNT);
+    double heldSince[keyCount];
+    double held[keyCount];
+    for (int i = 0; i < keyCount; i++) {
+        heldSince[i] = tickStart;
+        held[i] = 0.0;
+    }
+    bool enter = false;
+    InputEvent event;
+    while (events.popUntil(tickEnd, event)) {
+        int index = static_cast<int>(event.key);
+        // An event from before this tick counts as happening at its start
+        double time = event.time > tickStart ? event.time : tickStart;
+        if (tickDown[index]) {
+            held[index] += time - heldSince[index];
+        }
+        tickDown[index] = event.down;
+        heldSince[index] = time;
+        if (event.key == InputKey::ENTER && event.down) {
+            enter = true;
+        }
+        if (consumedChange == 0) {
+            consumedChange = event.observedAt;
+        }
+    }
+
+    double span = tickEnd - tickStart;
+    uint16_t amounts[keyCount];
+    for (int i = 0; i < keyCount; i++) {
+        if (tickDown[i]) {
+            held[i] += tickEnd - heldSince[i];
+        }
+        if (span <= 0.0) {
+            amounts[i] = tickDown[i] ? InputFrame::WHOLE_TICK : 0;
+            continue;
+        }
+        double fraction = held[i] / span;
+        fraction = fraction < 1.0 ? fraction : 1.0;
+        amounts[i] = (uint16_t)(fraction * InputFrame::WHOLE_TICK + 0.5);
+    }
+    return InputFrame{ amounts[static_cast<int>(InputKey::LEFT)], amounts[static_cast<int>(InputKey::RIGHT)], enter };
+}
+
+inline bool InputHandler::hasPendingInput() const {
+    return heldKeys.load(std::memory_order_relaxed) != 0 || !events.isEmpty();
+}
+
+inline std::chrono::steady_clock::time_point InputHandler::takeConsumedChange() {
+    long long change = consumedChange;
+    consumedChange = 0;
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(change));
+}
+
 inline void InputHandler::handleInput(Player* player, float deltaTime) {
-    if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A)) {
-        leftCommand->execute(player, deltaTime);
+    if (frame.left) {
+        leftCommand->execute(player, deltaTime * InputFrame::toFraction(frame.left));
     }
 
-    if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D)) {
-        rightCommand->execute(player, deltaTime);
+    if (frame.right) {
+        rightCommand->execute(player, deltaTime * InputFrame::toFraction(frame.right));
     }
 }
\ No newline at end of file
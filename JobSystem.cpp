@@ -0,0 +1,139 @@
+#include "JobSystem.h"
+
+JobSystem::JobSystem(int threadCount) :
+    function(nullptr),
+    context(nullptr),
+    itemCount(0),
+    chunkSize(1),
+    remaining(0),
+    generation(0),
+    stopping(false)
+{
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+    for (int i = 0; i < threadCount; i++) {
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    // Queue 0 belongs to the thread that calls parallelFor
+    for (int i = 1; i < threadCount; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeSignal.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// Chunks are never smaller than minChunkSize, and never so many that the
+// queues could overflow.
+size_t JobSystem::chunkSizeFor(size_t count, size_t minChunkSize) const {
+    size_t size = minChunkSize > 0 ? minChunkSize : 1;
+    size_t maxChunks = queues.size() * QUEUE_CAPACITY;
+    if ((count + size - 1) / size > maxChunks) {
+        size = (count + maxChunks - 1) / maxChunks;
+    }
+    return size;
+}
+
+size_t JobSystem::getChunkCount(size_t count, size_t minChunkSize) const {
+    size_t size = chunkSizeFor(count, minChunkSize);
+    return (count + size - 1) / size;
+}
+
+void JobSystem::workerLoop(int queueIndex) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeSignal.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+        runChunks(queueIndex);
+    }
+}
+
+bool JobSystem::popOwn(int queueIndex, uint32_t& chunk) {
+    WorkQueue& queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.head == queue.tail) {
+        return false;
+    }
+    chunk = queue.chunks[--queue.tail];
+    return true;
+}
+
+bool JobSystem::steal(int queueIndex, uint32_t& chunk) {
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        WorkQueue& queue = *queues[(queueIndex + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.head != queue.tail) {
+            chunk = queue.chunks[queue.head++];
+            return true;
+        }
+    }
+    return false;
+}
+
+// Runs chunks until none are queued anywhere. Chunks still running on other
+// threads are left to them.
+void JobSystem::runChunks(int queueIndex) {
+    uint32_t chunk;
+    while (popOwn(queueIndex, chunk) || steal(queueIndex, chunk)) {
+        size_t begin = chunk * chunkSize;
+        size_t end = begin + chunkSize < itemCount ? begin + chunkSize : itemCount;
+        function(context, chunk, begin, end);
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void JobSystem::run(size_t count, size_t minChunkSize, ChunkFunction chunkFunction, void* chunkContext) {
+    if (count == 0) {
+        return;
+    }
+    size_t size = chunkSizeFor(count, minChunkSize);
+    size_t chunks = (count + size - 1) / size;
+    if (queues.size() == 1 || chunks == 1) {
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            size_t begin = chunk * size;
+            chunkFunction(chunkContext, chunk, begin, begin + size < count ? begin + size : count);
+        }
+        return;
+    }
+
+    function = chunkFunction;
+    context = chunkContext;
+    itemCount = count;
+    chunkSize = size;
+    remaining.store(chunks, std::memory_order_relaxed);
+    // Dealt in reverse so each thread pops its lowest-numbered chunk first
+    for (size_t chunk = chunks; chunk > 0; chunk--) {
+        WorkQueue& queue = *queues[(chunk - 1) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.head == queue.tail) {
+            queue.head = 0;
+            queue.tail = 0;
+        }
+        queue.chunks[queue.tail++] = (uint32_t)(chunk - 1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        generation++;
+    }
+    wakeSignal.notify_all();
+
+    runChunks(0);
+    while (remaining.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Splits loops into chunks and runs them on a fixed set of worker threads
+// plus the calling thread. Chunks are dealt round-robin into one queue per
+// thread; a thread works through its own queue from the back and, once it
+// is empty, steals from the front of the others. Only one parallelFor runs
+// at a time, and it returns once every chunk has finished.
+class JobSystem {
+private:
+    static const size_t QUEUE_CAPACITY = 256;
+
+    struct WorkQueue {
+        std::mutex mutex;
+        uint32_t chunks[QUEUE_CAPACITY];
+        size_t head;
+        size_t tail;
+
+        WorkQueue() : chunks(), head(0), tail(0) {}
+    };
+
+    typedef void (*ChunkFunction)(void* context, size_t chunk, size_t begin, size_t end);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+
+    // The loop in flight; written before its chunks are queued
+    ChunkFunction function;
+    void* context;
+    size_t itemCount;
+    size_t chunkSize;
+    std::atomic<size_t> remaining;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeSignal;
+    uint64_t generation;
+    bool stopping;
+
+    size_t chunkSizeFor(size_t count, size_t minChunkSize) const;
+    void workerLoop(int queueIndex);
+    bool popOwn(int queueIndex, uint32_t& chunk);
+    bool steal(int queueIndex, uint32_t& chunk);
+    void runChunks(int queueIndex);
+    void run(size_t count, size_t minChunkSize, ChunkFunction chunkFunction, void* chunkContext);
+
+    template <typename F>
+    static void invoke(void* chunkContext, size_t chunk, size_t begin, size_t end) {
+        (*static_cast<F*>(chunkContext))(chunk, begin, end);
+    }
+
+public:
+    // threadCount counts the calling thread, so 1 runs everything inline
+    explicit JobSystem(int threadCount);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Calls body(chunk, begin, end) for consecutive ranges covering
+    // [0, count). Chunks are numbered in index order, so results written per
+    // chunk can be merged back in a fixed order whichever thread ran them.
+    template <typename F>
+    size_t parallelFor(size_t count, size_t minChunkSize, F& body) {
+        run(count, minChunkSize, &JobSystem::invoke<F>, &body);
+        return getChunkCount(count, minChunkSize);
+    }
+
+    size_t getChunkCount(size_t count, size_t minChunkSize) const;
+    int getThreadCount() const { return (int)queues.size(); }
+};
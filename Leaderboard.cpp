@@ -0,0 +1,412 @@
+#include "Leaderboard.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstring>
+
+// Kept out of raylib.h's way, as in MappedFile.cpp
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+const char* Leaderboard::DEFAULT_PATH = "leaderboard.cdgl";
+
+static const char LOG_MAGIC[4] = { 'C', 'D', 'G', 'L' };
+static const char TOP_MAGIC[4] = { 'C', 'D', 'G', 'T' };
+static const uint32_t LOG_VERSION = 1;
+static const uint32_t TOP_VERSION = 1;
+
+static_assert(sizeof(RunRecord) == 56, "RunRecord is stored as-is and must not change size");
+static_assert(sizeof(LeaderboardHeader) == 48, "LeaderboardHeader is stored as-is and must not change size");
+
+static uint32_t fnv1a(const void* data, size_t size, uint32_t hash = 2166136261u) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t recordChecksum(const RunRecord& record) {
+    return fnv1a(&record, offsetof(RunRecord, checksum));
+}
+
+static uint32_t topChecksum(const LeaderboardHeader& header, const RunRecord* records) {
+    uint32_t hash = fnv1a(&header, offsetof(LeaderboardHeader, checksum));
+    return fnv1a(records, header.count * sizeof(RunRecord), hash);
+}
+
+// Returns once the file's data is on disk, not just handed to the OS
+static bool syncFile(FILE* file) {
+    if (fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Atomic on both platforms: a crash leaves either the old file or the new one
+static bool replaceFile(const char* from, const char* to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+Leaderboard::Leaderboard() :
+    logPath(),
+    topPath(),
+    opened(false),
+    mutex(),
+    wakeSignal(),
+    writer(),
+    stopping(false),
+    pending(),
+    top(),
+    topCount(0),
+    totalRuns(0),
+    nextSequence(1),
+    log(nullptr),
+    generation(1),
+    logBytes(0),
+    historyRecords(0),
+    sinceCompaction(0),
+    persistedTop(),
+    persistedTopCount(0),
+    persistedRuns(0),
+    lastSequence(0)
+{
+}
+
+Leaderboard::~Leaderboard() {
+    close();
+}
+
+bool Leaderboard::open(const char* path) {
+    close();
+    logPath = path;
+    topPath = logPath + ".top";
+    persistedTopCount = 0;
+    persistedRuns = 0;
+    lastSequence = 0;
+    sinceCompaction = 0;
+
+    uint64_t validBytes = load();
+    if (!openLog(validBytes)) {
+        fprintf(stderr, "leaderboard: cannot write %s\n", path);
+        return false;
+    }
+    for (size_t i = 0; i < persistedTopCount; i++) {
+        top[i] = persistedTop[i];
+    }
+    topCount = persistedTopCount;
+    totalRuns = persistedRuns;
+    nextSequence = lastSequence + 1;
+
+    pending.reserve(COMPACT_INTERVAL);
+    stopping = false;
+    opened = true;
+    writer = std::thread([this] { runWriter(); });
+    return true;
+}
+
+// The top file is taken as it stands. Of the log, only records past the
+// point the top file covers are read, unless the log was rewritten since;
+// records it already counted are skipped either way. Reading stops at the
+// first record whose checksum fails, which can only be a torn write at the end.
+uint64_t Leaderboard::load() {
+    uint32_t topGeneration = 0;
+    uint64_t coveredBytes = 0;
+    bool haveTop = false;
+    MappedFile topFile;
+    if (topFile.open(topPath.c_str()) && topFile.getSize() >= sizeof(LeaderboardHeader)) {
+        LeaderboardHeader header;
+        memcpy(&header, topFile.getData(), sizeof(header));
+        const RunRecord* records = reinterpret_cast<const RunRecord*>(topFile.getData() + sizeof(header));
+        bool valid = memcmp(header.magic, TOP_MAGIC, sizeof(TOP_MAGIC)) == 0 &&
+            header.version == TOP_VERSION && header.count <= TOP_COUNT &&
+            topFile.getSize() == sizeof(header) + header.count * sizeof(RunRecord) &&
+            topChecksum(header, records) == header.checksum;
+        if (valid) {
+            memcpy(persistedTop, records, header.count * sizeof(RunRecord));
+            persistedTopCount = header.count;
+            persistedRuns = header.totalRuns;
+            lastSequence = header.lastSequence;
+            topGeneration = header.generation;
+            coveredBytes = header.coveredBytes;
+            haveTop = true;
+        }
+    }
+    topFile.close();
+
+    // A new log must not be mistaken for the one the top file came from
+    generation = haveTop ? topGeneration + 1 : 1;
+    MappedFile logFile;
+    if (!logFile.open(logPath.c_str()) || logFile.getSize() < sizeof(RunLogHeader)) {
+        return 0;
+    }
+    RunLogHeader header;
+    memcpy(&header, logFile.getData(), sizeof(header));
+    if (memcmp(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0 || header.version != LOG_VERSION) {
+        fprintf(stderr, "leaderboard: %s is not a run log, starting a new one\n", logPath.c_str());
+        return 0;
+    }
+    generation = header.generation;
+
+    uint64_t offset = sizeof(header);
+    size_t size = logFile.getSize();
+    if (haveTop && header.generation == topGeneration && coveredBytes >= offset && coveredBytes <= size &&
+        (coveredBytes - offset) % sizeof(RunRecord) == 0) {
+        offset = coveredBytes;
+    }
+    while (offset + sizeof(RunRecord) <= size) {
+        RunRecord record;
+        memcpy(&record, logFile.getData() + offset, sizeof(record));
+        if (recordChecksum(record) != record.checksum) {
+            break;
+        }
+        if (record.sequence > lastSequence) {
+            insertTop(persistedTop, persistedTopCount, record);
+            persistedRuns++;
+            lastSequence = record.sequence;
+            sinceCompaction++;
+        }
+        offset += sizeof(RunRecord);
+    }
+    historyRecords = (offset - sizeof(header)) / sizeof(RunRecord);
+    return offset;
+}
+
+// Appending starts right after the last intact record, over any torn one
+bool Leaderboard::openLog(uint64_t validBytes) {
+    if (validBytes > 0) {
+        log = fopen(logPath.c_str(), "r+b");
+        if (log != nullptr && fseek(log, (long)validBytes, SEEK_SET) == 0) {
+            logBytes = validBytes;
+            return true;
+        }
+    }
+    else {
+        log = fopen(logPath.c_str(), "w+b");
+        RunLogHeader header = { { 'C', 'D', 'G', 'L' }, LOG_VERSION, generation, 0 };
+        if (log != nullptr && fwrite(&header, sizeof(header), 1, log) == 1 && syncFile(log)) {
+            logBytes = sizeof(header);
+            historyRecords = 0;
+            return true;
+        }
+    }
+    if (log != nullptr) {
+        fclose(log);
+        log = nullptr;
+    }
+    return false;
+}
+
+void Leaderboard::close() {
+    if (!opened) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeSignal.notify_one();
+    writer.join();
+    if (log != nullptr) {
+        fclose(log);
+        log = nullptr;
+    }
+    opened = false;
+}
+
+void Leaderboard::submit(RunRecord record) {
+    if (!opened) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        record.sequence = nextSequence++;
+        record.reserved = 0;
+        record.checksum = recordChecksum(record);
+        insertTop(top, topCount, record);
+        totalRuns++;
+        pending.push_back(record);
+    }
+    wakeSignal.notify_one();
+}
+
+// The lock is only held to swap the queue out; all file work happens
+// without it, so submit() never waits on the disk
+void Leaderboard::runWriter() {
+    std::vector<RunRecord> batch;
+    batch.reserve(COMPACT_INTERVAL);
+    bool stop = false;
+    while (!stop) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeSignal.wait(lock, [this] { return stopping || !pending.empty(); });
+            batch.swap(pending);
+            stop = stopping;
+        }
+        for (const RunRecord& record : batch) {
+            append(record);
+        }
+        batch.clear();
+        if (sinceCompaction >= COMPACT_INTERVAL) {
+            compact();
+        }
+    }
+    if (sinceCompaction > 0) {
+        compact();
+    }
+}
+
+void Leaderboard::append(const RunRecord& record) {
+    if (log == nullptr) {
+        return;
+    }
+    if (fwrite(&record, sizeof(record), 1, log) != 1 || !syncFile(log)) {
+        fprintf(stderr, "leaderboard: cannot append to %s\n", logPath.c_str());
+        fseek(log, (long)logBytes, SEEK_SET);
+        return;
+    }
+    logBytes += sizeof(record);
+    historyRecords++;
+    sinceCompaction++;
+    insertTop(persistedTop, persistedTopCount, record);
+    persistedRuns++;
+    lastSequence = record.sequence;
+}
+
+// Trims the history if it has grown too long, then saves the top file,
+// which from then on covers everything in the log
+void Leaderboard::compact() {
+    if (log == nullptr) {
+        return;
+    }
+    if (historyRecords > MAX_HISTORY && !trimLog()) {
+        fprintf(stderr, "leaderboard: cannot compact %s\n", logPath.c_str());
+    }
+    if (writeTop()) {
+        sinceCompaction = 0;
+    }
+}
+
+// Copies the newest MAX_HISTORY records into a new log, which then replaces
+// the old one
+bool Leaderboard::trimLog() {
+    std::vector<RunRecord> records(MAX_HISTORY);
+    uint64_t keptBytes = (uint64_t)MAX_HISTORY * sizeof(RunRecord);
+    bool read = fseek(log, (long)(logBytes - keptBytes), SEEK_SET) == 0 &&
+        fread(records.data(), sizeof(RunRecord), MAX_HISTORY, log) == MAX_HISTORY;
+    fseek(log, (long)logBytes, SEEK_SET);
+    if (!read) {
+        return false;
+    }
+
+    std::string tempPath = logPath + ".tmp";
+    FILE* temp = fopen(tempPath.c_str(), "wb");
+    if (temp == nullptr) {
+        return false;
+    }
+    RunLogHeader header = { { 'C', 'D', 'G', 'L' }, LOG_VERSION, generation + 1, 0 };
+    bool written = fwrite(&header, sizeof(header), 1, temp) == 1 &&
+        fwrite(records.data(), sizeof(RunRecord), MAX_HISTORY, temp) == MAX_HISTORY &&
+        syncFile(temp);
+    fclose(temp);
+    if (!written) {
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    // The log has to be closed before it can be replaced on Windows
+    fclose(log);
+    bool replaced = replaceFile(tempPath.c_str(), logPath.c_str());
+    if (replaced) {
+        generation = header.generation;
+        logBytes = sizeof(header) + keptBytes;
+        historyRecords = MAX_HISTORY;
+    }
+    else {
+        remove(tempPath.c_str());
+    }
+    log = fopen(logPath.c_str(), "r+b");
+    if (log == nullptr || fseek(log, (long)logBytes, SEEK_SET) != 0) {
+        fprintf(stderr, "leaderboard: lost %s, runs are no longer saved\n", logPath.c_str());
+        if (log != nullptr) {
+            fclose(log);
+            log = nullptr;
+        }
+        return false;
+    }
+    return replaced;
+}
+
+bool Leaderboard::writeTop() {
+    LeaderboardHeader header = {
+        { 'C', 'D', 'G', 'T' }, TOP_VERSION, generation, (uint32_t)persistedTopCount,
+        lastSequence, logBytes, persistedRuns, 0, 0
+    };
+    header.checksum = topChecksum(header, persistedTop);
+
+    std::string tempPath = topPath + ".tmp";
+    FILE* temp = fopen(tempPath.c_str(), "wb");
+    if (temp == nullptr) {
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, temp) == 1 &&
+        fwrite(persistedTop, sizeof(RunRecord), persistedTopCount, temp) == persistedTopCount &&
+        syncFile(temp);
+    fclose(temp);
+    if (!written || !replaceFile(tempPath.c_str(), topPath.c_str())) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Highest score first; a tie goes to the earlier run
+void Leaderboard::insertTop(RunRecord* list, size_t& count, const RunRecord& record) {
+    size_t position = count;
+    while (position > 0 && list[position - 1].score < record.score) {
+        position--;
+    }
+    if (position >= TOP_COUNT) {
+        return;
+    }
+    size_t last = count < TOP_COUNT ? count : TOP_COUNT - 1;
+    for (size_t i = last; i > position; i--) {
+        list[i] = list[i - 1];
+    }
+    list[position] = record;
+    if (count < TOP_COUNT) {
+        count++;
+    }
+}
+
+int Leaderboard::getBestScore() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return topCount > 0 ? top[0].score : 0;
+}
+
+size_t Leaderboard::getTop(RunRecord* records, size_t maxRecords) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = topCount < maxRecords ? topCount : maxRecords;
+    for (size_t i = 0; i < count; i++) {
+        records[i] = top[i];
+    }
+    return count;
+}
+
+unsigned long long Leaderboard::getTotalRuns() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totalRuns;
+}
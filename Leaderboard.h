@@ -0,0 +1,132 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ObjectType DIAMOND to SILVERBAR; dynamite is never collected
+static const int GEM_TYPE_COUNT = 5;
+
+enum class RunEnd : uint32_t {
+    DYNAMITE,
+    QUIT
+};
+
+// One finished run, stored as-is in both files. checksum is FNV-1a over
+// every byte before it, so a record torn by a crash is recognized and
+// skipped.
+struct RunRecord {
+    uint64_t sequence;
+    int64_t endedAt;        // unix time
+    int32_t score;
+    float duration;         // seconds of play
+    uint32_t gems[GEM_TYPE_COUNT];
+    RunEnd cause;
+    uint32_t reserved;
+    uint32_t checksum;
+};
+
+// Files, little endian:
+//   log:  RunLogHeader, then one RunRecord per run, appended as runs end
+//   top:  LeaderboardHeader, then the best RunRecords, highest score first
+// The top file is rewritten whole, to a temporary file that then replaces
+// it, every COMPACT_INTERVAL runs and on close. It records the last
+// sequence it covers and how far into the log that was, so loading maps it
+// and only reads the log records appended after it.
+struct RunLogHeader {
+    char magic[4];
+    uint32_t version;
+    // Bumped whenever compaction rewrites the log, which moves its records
+    uint32_t generation;
+    uint32_t reserved;
+};
+
+struct LeaderboardHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t generation;
+    uint32_t count;
+    uint64_t lastSequence;
+    uint64_t coveredBytes;
+    uint64_t totalRuns;
+    uint32_t reserved;
+    // Over the header before it and the records after it
+    uint32_t checksum;
+};
+
+// Persistent top scores and run history. submit() only queues the run; a
+// background thread appends it to the log, so ending a run never waits on
+// the disk.
+class Leaderboard {
+public:
+    static const size_t TOP_COUNT = 10;
+    static const uint32_t COMPACT_INTERVAL = 32;
+    // Compaction drops the oldest runs beyond this many
+    static const uint32_t MAX_HISTORY = 10000;
+    static const char* DEFAULT_PATH;
+
+private:
+    std::string logPath;
+    std::string topPath;
+    bool opened;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeSignal;
+    std::thread writer;
+    bool stopping;
+    // Runs submitted but not yet handed to the writer
+    std::vector<RunRecord> pending;
+    // Everything submitted so far, for the game to show
+    RunRecord top[TOP_COUNT];
+    size_t topCount;
+    uint64_t totalRuns;
+    uint64_t nextSequence;
+
+    // Writer thread only, once open() has returned. persistedTop holds what
+    // is in the log, which is what a compaction may write out.
+    FILE* log;
+    uint32_t generation;
+    uint64_t logBytes;
+    uint64_t historyRecords;
+    uint32_t sinceCompaction;
+    RunRecord persistedTop[TOP_COUNT];
+    size_t persistedTopCount;
+    uint64_t persistedRuns;
+    uint64_t lastSequence;
+
+    // Returns how many bytes at the start of the log hold intact records
+    uint64_t load();
+    bool openLog(uint64_t validBytes);
+    void runWriter();
+    void append(const RunRecord& record);
+    void compact();
+    bool trimLog();
+    bool writeTop();
+
+    static void insertTop(RunRecord* list, size_t& count, const RunRecord& record);
+
+public:
+    Leaderboard();
+    ~Leaderboard();
+
+    Leaderboard(const Leaderboard&) = delete;
+    Leaderboard& operator=(const Leaderboard&) = delete;
+
+    // Loads the leaderboard at path, creating it if needed, and starts the
+    // writer. Returns false if the log cannot be written.
+    bool open(const char* path);
+    // Waits for queued runs to be written, compacts and stops the writer
+    void close();
+
+    // Fills in sequence and checksum, then queues the run for writing
+    void submit(RunRecord record);
+
+    bool isOpen() const { return opened; }
+    int getBestScore() const;
+    // Copies up to maxRecords of the best runs into records, best first
+    size_t getTop(RunRecord* records, size_t maxRecords) const;
+    unsigned long long getTotalRuns() const;
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+
+// Read-only view of a whole file. Pages are loaded by the OS on first touch,
+// so opening a large file costs nothing until its bytes are used.
+class MappedFile {
+private:
+    const unsigned char* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int descriptor;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    const unsigned char* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
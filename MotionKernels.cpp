@@ -0,0 +1,307 @@
+#include "MotionKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MOTION_KERNELS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC accepts any intrinsic in any function
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+// The rest of the file builds for the baseline ISA; only these functions may
+// use the wider instructions, and they run only after detection allows it
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// The vector kernels repeat this arithmetic operation for operation, with no
+// fused multiply-add, so every level rounds the same way.
+static void integrateScalar(const MotionArrays& m, size_t begin, size_t end, float deltaTime, float screenBottom) {
+    float turn = 90.0f * deltaTime;
+    for (size_t i = begin; i < end; i++) {
+        if (!m.active[i]) {
+            continue;
+        }
+        m.previousY[i] = m.y[i];
+        m.previousRotation[i] = m.rotation[i];
+        m.y[i] += m.speed[i] * 60.0f * deltaTime;
+        m.rotation[i] += turn;
+        if (m.y[i] > screenBottom + m.size[i]) {
+            m.active[i] = 0;
+        }
+    }
+}
+
+// Same test as raylib's CheckCollisionRecs on the object's square
+static inline bool overlaps(const MotionArrays& m, size_t i, Rectangle box, float boxRight, float boxBottom) {
+    float half = m.size[i] * 0.5f;
+    float left = m.x[i] - half;
+    float top = m.y[i] - half;
+    return m.active[i] && left < boxRight && left + m.size[i] > box.x && top < boxBottom && top + m.size[i] > box.y;
+}
+
+static size_t collideScalar(const MotionArrays& m, size_t begin, size_t end, Rectangle box, uint32_t* hits) {
+    float boxRight = box.x + box.width;
+    float boxBottom = box.y + box.height;
+    size_t count = 0;
+    for (size_t i = begin; i < end; i++) {
+        if (overlaps(m, i, box, boxRight, boxBottom)) {
+            hits[count++] = (uint32_t)i;
+        }
+    }
+    return count;
+}
+
+static size_t cullScalar(const MotionArrays& m, size_t begin, size_t end, float bandTop, float bandBottom, uint32_t* candidates) {
+    size_t count = 0;
+    for (size_t i = begin; i < end; i++) {
+        if (m.active[i] && m.y[i] >= bandTop && m.y[i] <= bandBottom) {
+            candidates[count++] = (uint32_t)i;
+        }
+    }
+    return count;
+}
+
+size_t collideCandidates(const MotionArrays& m, const uint32_t* candidates, size_t count, Rectangle box, uint32_t* hits) {
+    float boxRight = box.x + box.width;
+    float boxBottom = box.y + box.height;
+    size_t found = 0;
+    for (size_t c = 0; c < count; c++) {
+        uint32_t i = candidates[c];
+        if (overlaps(m, i, box, boxRight, boxBottom)) {
+            hits[found++] = i;
+        }
+    }
+    return found;
+}
+
+#ifdef MOTION_KERNELS_X86
+
+TARGET_SSE2 static void integrateSse2(const MotionArrays& m, size_t begin, size_t end, float deltaTime, float screenBottom) {
+    const __m128 sixty = _mm_set1_ps(60.0f);
+    const __m128 step = _mm_set1_ps(deltaTime);
+    const __m128 turn = _mm_set1_ps(90.0f * deltaTime);
+    const __m128 bottom = _mm_set1_ps(screenBottom);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128i active = _mm_loadu_si128((const __m128i*)(m.active + i));
+        __m128 live = _mm_castsi128_ps(_mm_cmpgt_epi32(active, zero));
+        if (_mm_movemask_ps(live) == 0) {
+            continue;
+        }
+        __m128 y = _mm_loadu_ps(m.y + i);
+        __m128 rotation = _mm_loadu_ps(m.rotation + i);
+        __m128 movedY = _mm_add_ps(y, _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(m.speed + i), sixty), step));
+        __m128 turned = _mm_add_ps(rotation, turn);
+        // SSE2 has no blend, so select with and/andnot/or
+        _mm_storeu_ps(m.previousY + i, _mm_or_ps(_mm_and_ps(live, y), _mm_andnot_ps(live, _mm_loadu_ps(m.previousY + i))));
+        _mm_storeu_ps(m.previousRotation + i, _mm_or_ps(_mm_and_ps(live, rotation), _mm_andnot_ps(live, _mm_loadu_ps(m.previousRotation + i))));
+        _mm_storeu_ps(m.y + i, _mm_or_ps(_mm_and_ps(live, movedY), _mm_andnot_ps(live, y)));
+        _mm_storeu_ps(m.rotation + i, _mm_or_ps(_mm_and_ps(live, turned), _mm_andnot_ps(live, rotation)));
+        __m128 gone = _mm_cmpgt_ps(movedY, _mm_add_ps(bottom, _mm_loadu_ps(m.size + i)));
+        __m128i stillActive = _mm_castps_si128(_mm_andnot_ps(gone, live));
+        _mm_storeu_si128((__m128i*)(m.active + i), _mm_srli_epi32(stillActive, 31));
+    }
+    integrateScalar(m, i, end, deltaTime, screenBottom);
+}
+
+TARGET_SSE2 static size_t collideSse2(const MotionArrays& m, size_t begin, size_t end, Rectangle box, uint32_t* hits) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 boxLeft = _mm_set1_ps(box.x);
+    const __m128 boxTop = _mm_set1_ps(box.y);
+    const __m128 boxRight = _mm_set1_ps(box.x + box.width);
+    const __m128 boxBottom = _mm_set1_ps(box.y + box.height);
+    const __m128i zero = _mm_setzero_si128();
+    size_t count = 0;
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 size = _mm_loadu_ps(m.size + i);
+        __m128 left = _mm_sub_ps(_mm_loadu_ps(m.x + i), _mm_mul_ps(size, half));
+        __m128 top = _mm_sub_ps(_mm_loadu_ps(m.y + i), _mm_mul_ps(size, half));
+        __m128 overlap = _mm_and_ps(
+            _mm_and_ps(_mm_cmplt_ps(left, boxRight), _mm_cmpgt_ps(_mm_add_ps(left, size), boxLeft)),
+            _mm_and_ps(_mm_cmplt_ps(top, boxBottom), _mm_cmpgt_ps(_mm_add_ps(top, size), boxTop)));
+        __m128i active = _mm_loadu_si128((const __m128i*)(m.active + i));
+        int mask = _mm_movemask_ps(_mm_and_ps(overlap, _mm_castsi128_ps(_mm_cmpgt_epi32(active, zero))));
+        for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+            if (mask & 1) {
+                hits[count++] = (uint32_t)(i + lane);
+            }
+        }
+    }
+    return count + collideScalar(m, i, end, box, hits + count);
+}
+
+TARGET_SSE2 static size_t cullSse2(const MotionArrays& m, size_t begin, size_t end, float bandTop, float bandBottom, uint32_t* candidates) {
+    const __m128 top = _mm_set1_ps(bandTop);
+    const __m128 bottom = _mm_set1_ps(bandBottom);
+    const __m128i zero = _mm_setzero_si128();
+    size_t count = 0;
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 y = _mm_loadu_ps(m.y + i);
+        __m128 inBand = _mm_and_ps(_mm_cmpge_ps(y, top), _mm_cmple_ps(y, bottom));
+        __m128i active = _mm_loadu_si128((const __m128i*)(m.active + i));
+        int mask = _mm_movemask_ps(_mm_and_ps(inBand, _mm_castsi128_ps(_mm_cmpgt_epi32(active, zero))));
+        for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+            if (mask & 1) {
+                candidates[count++] = (uint32_t)(i + lane);
+            }
+        }
+    }
+    return count + cullScalar(m, i, end, bandTop, bandBottom, candidates + count);
+}
+
+TARGET_AVX2 static void integrateAvx2(const MotionArrays& m, size_t begin, size_t end, float deltaTime, float screenBottom) {
+    const __m256 sixty = _mm256_set1_ps(60.0f);
+    const __m256 step = _mm256_set1_ps(deltaTime);
+    const __m256 turn = _mm256_set1_ps(90.0f * deltaTime);
+    const __m256 bottom = _mm256_set1_ps(screenBottom);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256i active = _mm256_loadu_si256((const __m256i*)(m.active + i));
+        __m256 live = _mm256_castsi256_ps(_mm256_cmpgt_epi32(active, zero));
+        if (_mm256_movemask_ps(live) == 0) {
+            continue;
+        }
+        __m256 y = _mm256_loadu_ps(m.y + i);
+        __m256 rotation = _mm256_loadu_ps(m.rotation + i);
+        __m256 movedY = _mm256_add_ps(y, _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(m.speed + i), sixty), step));
+        __m256 turned = _mm256_add_ps(rotation, turn);
+        _mm256_storeu_ps(m.previousY + i, _mm256_blendv_ps(_mm256_loadu_ps(m.previousY + i), y, live));
+        _mm256_storeu_ps(m.previousRotation + i, _mm256_blendv_ps(_mm256_loadu_ps(m.previousRotation + i), rotation, live));
+        _mm256_storeu_ps(m.y + i, _mm256_blendv_ps(y, movedY, live));
+        _mm256_storeu_ps(m.rotation + i, _mm256_blendv_ps(rotation, turned, live));
+        __m256 gone = _mm256_cmp_ps(movedY, _mm256_add_ps(bottom, _mm256_loadu_ps(m.size + i)), _CMP_GT_OQ);
+        __m256i stillActive = _mm256_castps_si256(_mm256_andnot_ps(gone, live));
+        _mm256_storeu_si256((__m256i*)(m.active + i), _mm256_srli_epi32(stillActive, 31));
+    }
+    integrateScalar(m, i, end, deltaTime, screenBottom);
+}
+
+TARGET_AVX2 static size_t collideAvx2(const MotionArrays& m, size_t begin, size_t end, Rectangle box, uint32_t* hits) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 boxLeft = _mm256_set1_ps(box.x);
+    const __m256 boxTop = _mm256_set1_ps(box.y);
+    const __m256 boxRight = _mm256_set1_ps(box.x + box.width);
+    const __m256 boxBottom = _mm256_set1_ps(box.y + box.height);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t count = 0;
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 size = _mm256_loadu_ps(m.size + i);
+        __m256 left = _mm256_sub_ps(_mm256_loadu_ps(m.x + i), _mm256_mul_ps(size, half));
+        __m256 top = _mm256_sub_ps(_mm256_loadu_ps(m.y + i), _mm256_mul_ps(size, half));
+        __m256 overlap = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(left, boxRight, _CMP_LT_OQ), _mm256_cmp_ps(_mm256_add_ps(left, size), boxLeft, _CMP_GT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(top, boxBottom, _CMP_LT_OQ), _mm256_cmp_ps(_mm256_add_ps(top, size), boxTop, _CMP_GT_OQ)));
+        __m256i active = _mm256_loadu_si256((const __m256i*)(m.active + i));
+        int mask = _mm256_movemask_ps(_mm256_and_ps(overlap, _mm256_castsi256_ps(_mm256_cmpgt_epi32(active, zero))));
+        for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+            if (mask & 1) {
+                hits[count++] = (uint32_t)(i + lane);
+            }
+        }
+    }
+    return count + collideScalar(m, i, end, box, hits + count);
+}
+
+TARGET_AVX2 static size_t cullAvx2(const MotionArrays& m, size_t begin, size_t end, float bandTop, float bandBottom, uint32_t* candidates) {
+    const __m256 top = _mm256_set1_ps(bandTop);
+    const __m256 bottom = _mm256_set1_ps(bandBottom);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t count = 0;
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 y = _mm256_loadu_ps(m.y + i);
+        __m256 inBand = _mm256_and_ps(_mm256_cmp_ps(y, top, _CMP_GE_OQ), _mm256_cmp_ps(y, bottom, _CMP_LE_OQ));
+        __m256i active = _mm256_loadu_si256((const __m256i*)(m.active + i));
+        int mask = _mm256_movemask_ps(_mm256_and_ps(inBand, _mm256_castsi256_ps(_mm256_cmpgt_epi32(active, zero))));
+        for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+            if (mask & 1) {
+                candidates[count++] = (uint32_t)(i + lane);
+            }
+        }
+    }
+    return count + cullScalar(m, i, end, bandTop, bandBottom, candidates + count);
+}
+
+// AVX state must also be enabled by the OS, which cpuid alone does not say
+static bool cpuSupports(SimdLevel level) {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    bool avx2 = osAvx && (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    bool sse2 = __builtin_cpu_supports("sse2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    switch (level) {
+    case SimdLevel::AVX2: return avx2;
+    case SimdLevel::SSE2: return sse2;
+    default: return true;
+    }
+}
+
+#else
+
+static bool cpuSupports(SimdLevel level) {
+    return level == SimdLevel::SCALAR;
+}
+
+#endif
+
+static const MotionKernels* kernelsFor(SimdLevel level) {
+    static const MotionKernels scalar = { SimdLevel::SCALAR, integrateScalar, collideScalar, cullScalar };
+#ifdef MOTION_KERNELS_X86
+    static const MotionKernels sse2 = { SimdLevel::SSE2, integrateSse2, collideSse2, cullSse2 };
+    static const MotionKernels avx2 = { SimdLevel::AVX2, integrateAvx2, collideAvx2, cullAvx2 };
+    switch (level) {
+    case SimdLevel::AVX2: return &avx2;
+    case SimdLevel::SSE2: return &sse2;
+    default: break;
+    }
+#endif
+    return &scalar;
+}
+
+SimdLevel detectSimdLevel() {
+    if (cpuSupports(SimdLevel::AVX2)) {
+        return SimdLevel::AVX2;
+    }
+    if (cpuSupports(SimdLevel::SSE2)) {
+        return SimdLevel::SSE2;
+    }
+    return SimdLevel::SCALAR;
+}
+
+// Picked during static initialization, before any thread can ask
+static const MotionKernels* selected = kernelsFor(detectSimdLevel());
+
+const MotionKernels& getMotionKernels() {
+    return *selected;
+}
+
+bool setSimdLevel(SimdLevel level) {
+    if (!cpuSupports(level)) {
+        return false;
+    }
+    selected = kernelsFor(level);
+    return true;
+}
+
+const char* getSimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2: return "avx2";
+    case SimdLevel::SSE2: return "sse2";
+    default: return "scalar";
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "raylib.h"
+#include <cstddef>
+#include <cstdint>
+
+// The hot fields of FallingObjectPool, one array each. active[i] is 1 while
+// object i is falling and 0 once it has been caught or left the screen.
+struct MotionArrays {
+    float* x;
+    float* y;
+    float* previousY;
+    float* speed;
+    float* rotation;
+    float* previousRotation;
+    float* size;
+    uint32_t* active;
+};
+
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+// One tick of falling for the active objects in [begin, end): keeps the
+// previous y and rotation for interpolation, moves and spins them, and
+// deactivates the ones whose top has passed screenBottom.
+typedef void (*IntegrateKernel)(const MotionArrays& motion, size_t begin, size_t end,
+    float deltaTime, float screenBottom);
+// Writes the indices of active objects in [begin, end) that overlap box to
+// hits, in ascending order, and returns how many there were.
+typedef size_t (*CollideKernel)(const MotionArrays& motion, size_t begin, size_t end,
+    Rectangle box, uint32_t* hits);
+// Writes the indices of active objects in [begin, end) whose centre y lies
+// in [bandTop, bandBottom] to candidates, in ascending order, and returns
+// how many there were. Only y and active are read.
+typedef size_t (*CullKernel)(const MotionArrays& motion, size_t begin, size_t end,
+    float bandTop, float bandBottom, uint32_t* candidates);
+
+// Every level computes bit-identical results to the scalar code, so the
+// choice never changes a replay.
+struct MotionKernels {
+    SimdLevel level;
+    IntegrateKernel integrate;
+    CollideKernel collide;
+    CullKernel cull;
+};
+
+// The collide test on a list of indices, such as the output of cull. hits
+// may point at candidates, since it never gets ahead of them.
+size_t collideCandidates(const MotionArrays& motion, const uint32_t* candidates, size_t count,
+    Rectangle box, uint32_t* hits);
+
+// The widest level this CPU and OS support
+SimdLevel detectSimdLevel();
+// The detected level's kernels, unless setSimdLevel picked others. Call
+// setSimdLevel before any worker thread starts using them.
+const MotionKernels& getMotionKernels();
+bool setSimdLevel(SimdLevel level);
+const char* getSimdLevelName(SimdLevel level);
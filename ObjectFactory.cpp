@@ -1,141 +1,80 @@
 #include "ObjectFactory.h"
 #include "GameManager.h"
+#include "Random.h"
 #include <cstdlib>
 
-FallingObject::FallingObject(Vector2 startPos, float fallingSpeed, Texture2D objTexture,
-    float objSize, ObjectType objType, int scoreValue) :
-    position(startPos),
-    speed(fallingSpeed),
-    texture(objTexture),
-    size(objSize),
-    active(true),
-    type(objType),
-    score(scoreValue),
-    rotation(0.0f)
+ObjectFactory::ObjectFactory(size_t poolCapacity) :
+    pool(poolCapacity),
+    spawnTable()
 {
 }
 
-void FallingObject::update(float deltaTime) {
-    position.y += speed * 60 * deltaTime;
-    rotation += 90.0f * deltaTime;
-
-    if (isOffScreen()) {
-        active = false;
+SpriteId ObjectFactory::getSprite(ObjectType type) {
+    switch (type) {
+    case ObjectType::DIAMOND: return SpriteId::DIAMOND;
+    case ObjectType::RUBY: return SpriteId::RUBY;
+    case ObjectType::AMETHYST: return SpriteId::AMETHYST;
+    case ObjectType::GOLDBAR: return SpriteId::GOLDBAR;
+    case ObjectType::SILVERBAR: return SpriteId::SILVERBAR;
+    default: return SpriteId::DYNAMITE;
     }
 }
 
-void FallingObject::render() const {
-    if (!active) return;
-
-    DrawTexturePro(
-        texture,
-        Rectangle{ 0, 0, (float)texture.width, (float)texture.height },
-        Rectangle{ position.x, position.y, size, size },
-        Vector2{ size / 2, size / 2 },
-        rotation,
-        WHITE
-    );
-}
-
-bool FallingObject::checkCollision(Rectangle other) const {
-    Rectangle objRect = {
-        position.x - size / 2,
-        position.y - size / 2,
-        size,
-        size
-    };
-    return CheckCollisionRecs(objRect, other);
-}
-
-bool FallingObject::isOffScreen() const {
-    GameManager* gm = GameManager::getInstance();
-    return position.y > gm->getScreenHeight() + size;
+float ObjectFactory::getMaxObjectSize() const {
+    return spawnTable.getMaxSize();
 }
 
-Color FallingObject::getScoreColor() const {
-    switch (type) {
-    case ObjectType::DIAMOND: return SKYBLUE;
-    case ObjectType::RUBY: return RED;
-    case ObjectType::AMETHYST: return PURPLE;
-    case ObjectType::GOLDBAR: return GOLD;
-    case ObjectType::SILVERBAR: return LIGHTGRAY;
-    default: return WHITE;
-    }
+ObjectHandle ObjectFactory::createObject() {
+    ObjectHandle handle = ObjectHandle::invalid();
+    createObjects(1, &handle);
+    return handle;
 }
 
-ObjectFactory::ObjectFactory() {
-    objectTextures[static_cast<int>(ObjectType::DIAMOND)] = LoadTexture("Resources/Diamond.png");
-    objectTextures[static_cast<int>(ObjectType::RUBY)] = LoadTexture("Resources/Ruby.png");
-    objectTextures[static_cast<int>(ObjectType::AMETHYST)] = LoadTexture("Resources/Amethyst.png");
-    objectTextures[static_cast<int>(ObjectType::GOLDBAR)] = LoadTexture("Resources/Gold.png");
-    objectTextures[static_cast<int>(ObjectType::SILVERBAR)] = LoadTexture("Resources/Silver.png");
-    objectTextures[static_cast<int>(ObjectType::DYNAMITE)] = LoadTexture("Resources/Dynamite.png");
-}
-
-ObjectFactory::~ObjectFactory() {
-    for (int i = 0; i < static_cast<int>(ObjectType::COUNT); i++) {
-        UnloadTexture(objectTextures[i]);
+ObjectHandle ObjectFactory::createObject(ObjectType type) {
+    if (pool.isFull()) {
+        return ObjectHandle::invalid();
     }
+    Random& positionRandom = GameManager::getInstance()->getRandom(RandomStream::SPAWN_POSITION);
+    uint32_t positionValue = positionRandom.next();
+    return spawn(type, positionValue, positionRandom.next());
 }
 
-FallingObject* ObjectFactory::createObject() {
+// The random values for a whole batch are drawn up front, one stream at a
+// time, and only then turned into objects.
+size_t ObjectFactory::createObjects(size_t count, ObjectHandle* handles) {
     GameManager* gm = GameManager::getInstance();
-    Vector2 startPos;
-    startPos.x = GetRandomValue(20, gm->getScreenWidth() - 20);
-    startPos.y = -50.0f;
-    float speed = GetRandomValue(150, 350) / 100.0f;
-    float size = 50.0f;
-
-    int randomValue = GetRandomValue(1, 100);
-    ObjectType type;
-    int scoreValue;
-
-    if (randomValue <= 5) {
-        type = ObjectType::DIAMOND;
-        scoreValue = 15;
-    }
-    else if (randomValue <= 13) {
-        type = ObjectType::RUBY;
-        scoreValue = 12;
-    }
-    else if (randomValue <= 25) {
-        type = ObjectType::AMETHYST;
-        scoreValue = 10;
-    }
-    else if (randomValue <= 50) {
-        type = ObjectType::GOLDBAR;
-        scoreValue = 8;
-    }
-    else if (randomValue <= 80) {
-        type = ObjectType::SILVERBAR;
-        scoreValue = 5;
-    }
-    else {
-        type = ObjectType::DYNAMITE;
-        scoreValue = 0;
+    Random& typeRandom = gm->getRandom(RandomStream::SPAWN_TYPE);
+    Random& positionRandom = gm->getRandom(RandomStream::SPAWN_POSITION);
+    size_t available = pool.capacity() - pool.size();
+    if (count > available) {
+        count = available;
     }
 
-    return new FallingObject(startPos, speed, objectTextures[static_cast<int>(type)], size, type, scoreValue);
+    uint32_t typeValues[SPAWN_BATCH];
+    uint32_t positionValues[SPAWN_BATCH * 2];
+    size_t created = 0;
+    while (created < count) {
+        size_t batch = count - created < SPAWN_BATCH ? count - created : SPAWN_BATCH;
+        typeRandom.fill(typeValues, batch);
+        positionRandom.fill(positionValues, batch * 2);
+        for (size_t i = 0; i < batch; i++) {
+            ObjectType type = spawnTable.sample(typeValues[i]);
+            handles[created++] = spawn(type, positionValues[i * 2], positionValues[i * 2 + 1]);
+        }
+    }
+    return created;
 }
 
-FallingObject* ObjectFactory::createObject(ObjectType type) {
+ObjectHandle ObjectFactory::spawn(ObjectType type, uint32_t positionValue, uint32_t speedValue) {
     GameManager* gm = GameManager::getInstance();
+    const SpawnEntry& entry = spawnTable.getEntry(type);
+    int minSpeed = (int)(entry.minSpeed * 100.0f + 0.5f);
+    int maxSpeed = (int)(entry.maxSpeed * 100.0f + 0.5f);
+
     Vector2 startPos;
-    startPos.x = GetRandomValue(20, gm->getScreenWidth() - 20);
+    startPos.x = (float)(20 + Random::bounded(positionValue, (uint32_t)(gm->getScreenWidth() - 40) + 1));
     startPos.y = -50.0f;
+    float speed = (minSpeed + (int)Random::bounded(speedValue, (uint32_t)(maxSpeed - minSpeed) + 1)) / 100.0f;
 
-    float speed = GetRandomValue(150, 350) / 100.0f;
-    float size = 50.0f;
-    int scoreValue;
-    switch (type) {
-    case ObjectType::DIAMOND: scoreValue = 15; break;
-    case ObjectType::RUBY: scoreValue = 12; break;
-    case ObjectType::AMETHYST: scoreValue = 10; break;
-    case ObjectType::GOLDBAR: scoreValue = 8; break;
-    case ObjectType::SILVERBAR: scoreValue = 5; break;
-    case ObjectType::DYNAMITE: scoreValue = 0; break;
-    default: scoreValue = 0;
-    }
-
-    return new FallingObject(startPos, speed, objectTextures[static_cast<int>(type)], size, type, scoreValue);
-}
\ No newline at end of file
+    return pool.acquire(startPos, speed, getSprite(type), entry.size, type, entry.score);
+}
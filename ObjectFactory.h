@@ -1,54 +1,34 @@
 #pragma once
 #include "raylib.h"
+#include "FallingObjectPool.h"
+#include "TextureAtlas.h"
+#include "SpawnTable.h"
 #include <string>
 
-enum class ObjectType {
-    DIAMOND,
-    RUBY,
-    AMETHYST,
-    GOLDBAR,
-    SILVERBAR,
-    DYNAMITE,
-    COUNT
-};
-
-class FallingObject {
+class ObjectFactory {
 private:
-    Vector2 position;
-    float speed;
-    Texture2D texture;
-    float size;
-    bool active;
-    ObjectType type;
-    int score;
-    float rotation;
-
-public:
-    FallingObject(Vector2 startPos, float fallingSpeed, Texture2D objTexture,
-        float objSize, ObjectType objType, int scoreValue);
+    FallingObjectPool pool;
+    SpawnTable spawnTable;
 
-    void update(float deltaTime);
-    void render() const;
-    bool checkCollision(Rectangle other) const;
-    bool isOffScreen() const;
+    ObjectHandle spawn(ObjectType type, uint32_t positionValue, uint32_t speedValue);
 
-    Vector2 getPosition() const { return position; }
-    bool isActive() const { return active; }
-    ObjectType getType() const { return type; }
-    int getScore() const { return score; }
-    Color getScoreColor() const;
+public:
+    static const size_t DEFAULT_POOL_CAPACITY = 256;
 
-    void setActive(bool isActive) { active = isActive; }
-};
+    explicit ObjectFactory(size_t poolCapacity = DEFAULT_POOL_CAPACITY);
 
-class ObjectFactory {
-private:
-    Texture2D objectTextures[static_cast<int>(ObjectType::COUNT)];
+    static const size_t SPAWN_BATCH = 64;
 
-public:
-    ObjectFactory();
-    ~ObjectFactory();
+    ObjectHandle createObject();
+    ObjectHandle createObject(ObjectType type);
+    // Spawns up to count objects from the spawn table, fewer if the pool
+    // fills up. Returns how many handles were written.
+    size_t createObjects(size_t count, ObjectHandle* handles);
+    void releaseAll() { pool.clear(); }
+    float getMaxObjectSize() const;
+    static SpriteId getSprite(ObjectType type);
 
-    FallingObject* createObject();
-    FallingObject* createObject(ObjectType type);
+    FallingObjectPool& getPool() { return pool; }
+    SpawnTable& getSpawnTable() { return spawnTable; }
+    const SpawnTable& getSpawnTable() const { return spawnTable; }
 };
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Handle into a pool built on SlotTable. The generation is bumped every time a slot is
+// released, so a handle kept past its object's lifetime is detected as stale.
+struct ObjectHandle {
+    uint32_t index;
+    uint32_t generation;
+
+    bool isValid() const { return generation != 0; }
+    static ObjectHandle invalid() { return ObjectHandle{ 0, 0 }; }
+};
+
+inline bool operator==(ObjectHandle a, ObjectHandle b) {
+    return a.index == b.index && a.generation == b.generation;
+}
+
+inline bool operator!=(ObjectHandle a, ObjectHandle b) {
+    return !(a == b);
+}
+
+// Handle bookkeeping for a fixed-capacity pool. Live objects are kept
+// densely packed in [0, size()) and removal swaps the last live object into
+// the hole, so iteration never skips over dead entries and no memory is
+// allocated after construction. The table only tracks indices; the pool that
+// owns it moves the object data to match.
+class SlotTable {
+private:
+    std::vector<uint32_t> denseToSlot;
+    std::vector<uint32_t> slotToDense;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeSlots;
+    size_t count;
+
+public:
+    explicit SlotTable(size_t maxObjects);
+
+    // The new object goes at dense index size() - 1
+    ObjectHandle acquire();
+    // Returns the dense index whose object must be moved into denseIndex; the
+    // same index when it was the last one
+    size_t releaseAt(size_t denseIndex);
+    void clear();
+
+    bool isAlive(ObjectHandle handle) const;
+    // Only valid for a live handle
+    size_t indexOf(ObjectHandle handle) const { return slotToDense[handle.index]; }
+    ObjectHandle handleAt(size_t denseIndex) const;
+
+    size_t size() const { return count; }
+    size_t capacity() const { return generations.size(); }
+    bool isFull() const { return freeSlots.empty(); }
+    bool isEmpty() const { return count == 0; }
+};
+
+inline SlotTable::SlotTable(size_t maxObjects) :
+    denseToSlot(maxObjects),
+    slotToDense(maxObjects),
+    generations(maxObjects, 1),
+    count(0)
+{
+    freeSlots.reserve(maxObjects);
+    for (size_t i = maxObjects; i > 0; i--) {
+        freeSlots.push_back(static_cast<uint32_t>(i - 1));
+    }
+}
+
+inline ObjectHandle SlotTable::acquire() {
+    if (freeSlots.empty()) {
+        return ObjectHandle::invalid();
+    }
+    uint32_t slot = freeSlots.back();
+    freeSlots.pop_back();
+
+    denseToSlot[count] = slot;
+    slotToDense[slot] = static_cast<uint32_t>(count);
+    count++;
+
+    return ObjectHandle{ slot, generations[slot] };
+}
+
+inline size_t SlotTable::releaseAt(size_t denseIndex) {
+    uint32_t slot = denseToSlot[denseIndex];
+    size_t last = count - 1;
+    if (denseIndex != last) {
+        uint32_t movedSlot = denseToSlot[last];
+        denseToSlot[denseIndex] = movedSlot;
+        slotToDense[movedSlot] = static_cast<uint32_t>(denseIndex);
+    }
+    count--;
+
+    generations[slot]++;
+    if (generations[slot] == 0) {
+        generations[slot] = 1;
+    }
+    freeSlots.push_back(slot);
+    return last;
+}
+
+inline void SlotTable::clear() {
+    while (count > 0) {
+        releaseAt(count - 1);
+    }
+}
+
+inline bool SlotTable::isAlive(ObjectHandle handle) const {
+    if (!handle.isValid() || handle.index >= generations.size()) {
+        return false;
+    }
+    if (generations[handle.index] != handle.generation) {
+        return false;
+    }
+    uint32_t denseIndex = slotToDense[handle.index];
+    return denseIndex < count && denseToSlot[denseIndex] == handle.index;
+}
+
+inline ObjectHandle SlotTable::handleAt(size_t denseIndex) const {
+    uint32_t slot = denseToSlot[denseIndex];
+    return ObjectHandle{ slot, generations[slot] };
+}
@@ -0,0 +1,221 @@
+#include "Platform.h"
+
+#ifdef COLLECTDGEMS_GLFW_INPUT
+#include <GLFW/glfw3.h>
+
+struct DeferredKey {
+    GLFWwindow* window;
+    int key;
+    int scancode;
+    int action;
+    int mods;
+};
+
+static const int MAX_DEFERRED_KEYS = 64;
+
+static KeyListener* keyListener = nullptr;
+static GLFWkeyfun raylibKeyCallback = nullptr;
+static bool pumping = false;
+// Keys seen by pumpEvents(), held back from raylib until its next poll
+static DeferredKey deferredKeys[MAX_DEFERRED_KEYS];
+static int deferredKeyCount = 0;
+
+// GLFW has no event timestamps, so an event is timed when its callback runs:
+// during EndDrawing()'s poll, or a pumpEvents() while the frame waits. The
+// listener hears it at once. raylib copies its key state to the previous
+// frame's only when it polls, so a key pumped mid-frame and passed on straight
+// away would be in both by the time isKeyPressed() looks, and never read as
+// pressed. Those wait here instead, and anything after them too, to keep the
+// order, until flushDeferredKeys() runs after raylib's poll.
+static void forwardKey(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if ((pumping || deferredKeyCount > 0) && deferredKeyCount < MAX_DEFERRED_KEYS) {
+        deferredKeys[deferredKeyCount++] = DeferredKey{ window, key, scancode, action, mods };
+    }
+    else if (raylibKeyCallback != nullptr) {
+        raylibKeyCallback(window, key, scancode, action, mods);
+    }
+    if (keyListener != nullptr && action != GLFW_REPEAT) {
+        keyListener->onKey(key, action == GLFW_PRESS, GetTime());
+    }
+}
+
+static void flushDeferredKeys() {
+    int count = deferredKeyCount;
+    deferredKeyCount = 0;
+    for (int i = 0; i < count && raylibKeyCallback != nullptr; i++) {
+        const DeferredKey& deferred = deferredKeys[i];
+        raylibKeyCallback(deferred.window, deferred.key, deferred.scancode, deferred.action, deferred.mods);
+    }
+}
+#else
+static void flushDeferredKeys() {
+}
+#endif
+
+RaylibPlatform::RaylibPlatform() :
+    frameStart(0.0),
+    vsync(false),
+    windowOpen(false)
+{
+}
+
+// The scene keeps its logical size whatever the window's; see RaylibRenderer
+void RaylibPlatform::openWindow(int width, int height, const char* title) {
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE | (vsync ? FLAG_VSYNC_HINT : 0));
+    InitWindow(width, height, title);
+    windowOpen = true;
+    frameStart = GetTime();
+}
+
+void RaylibPlatform::closeWindow() {
+    CloseWindow();
+    windowOpen = false;
+}
+
+bool RaylibPlatform::shouldClose() {
+    return WindowShouldClose();
+}
+
+void RaylibPlatform::setTargetFPS(int fps) {
+    SetTargetFPS(fps);
+}
+
+void RaylibPlatform::setVsync(bool enabled) {
+    vsync = enabled;
+    if (!windowOpen) {
+        return;
+    }
+    if (enabled) {
+        SetWindowState(FLAG_VSYNC_HINT);
+    }
+    else {
+        ClearWindowState(FLAG_VSYNC_HINT);
+    }
+}
+
+int RaylibPlatform::getRefreshRate() const {
+    int rate = GetMonitorRefreshRate(GetCurrentMonitor());
+    return rate > 0 ? rate : 60;
+}
+
+// Timed here rather than with GetFrameTime(), which runs from one
+// EndDrawing() to the next and so would count a skipped frame's whole wait
+float RaylibPlatform::getFrameTime() {
+    double now = GetTime();
+    float elapsed = (float)(now - frameStart);
+    frameStart = now;
+    return elapsed;
+}
+
+double RaylibPlatform::getTime() const {
+    return GetTime();
+}
+
+bool RaylibPlatform::isSuspended() const {
+    return IsWindowMinimized() || !IsWindowFocused();
+}
+
+bool RaylibPlatform::isWindowResized() const {
+    return IsWindowResized();
+}
+
+// Input is normally polled by EndDrawing(), which a skipped frame never calls
+void RaylibPlatform::waitForInput(float timeout) {
+    if (timeout < 0.0f) {
+        EnableEventWaiting();
+        PollInputEvents();
+        DisableEventWaiting();
+    }
+    else {
+        WaitTime(timeout);
+        PollInputEvents();
+    }
+    flushDeferredKeys();
+    frameStart = GetTime();
+}
+
+void RaylibPlatform::pollInput() {
+    PollInputEvents();
+    flushDeferredKeys();
+}
+
+bool RaylibPlatform::setKeyListener(KeyListener* listener) {
+#ifdef COLLECTDGEMS_GLFW_INPUT
+    // A GLFW other than the one inside raylib has no window, so there is no
+    // context and keys stay polled
+    GLFWwindow* window = glfwGetCurrentContext();
+    if (window == nullptr) {
+        return false;
+    }
+    GLFWkeyfun previous = glfwSetKeyCallback(window, listener != nullptr ? forwardKey : raylibKeyCallback);
+    if (previous != forwardKey) {
+        raylibKeyCallback = previous;
+    }
+    keyListener = listener;
+    return listener != nullptr;
+#else
+    return false;
+#endif
+}
+
+void RaylibPlatform::pumpEvents() {
+#ifdef COLLECTDGEMS_GLFW_INPUT
+    if (keyListener != nullptr) {
+        pumping = true;
+        glfwPollEvents();
+        pumping = false;
+    }
+#endif
+}
+
+bool RaylibPlatform::isKeyDown(int key) const {
+    return IsKeyDown(key);
+}
+
+bool RaylibPlatform::isKeyPressed(int key) const {
+    return IsKeyPressed(key);
+}
+
+NullPlatform::NullPlatform() :
+    frameTime(1.0f / 60.0f),
+    frameLimit(-1),
+    frameCount(0),
+    autoStart(true),
+    keysDown()
+{
+}
+
+void NullPlatform::openWindow(int width, int height, const char* title) {
+}
+
+void NullPlatform::closeWindow() {
+}
+
+bool NullPlatform::shouldClose() {
+    if (frameLimit >= 0 && frameCount >= frameLimit) {
+        return true;
+    }
+    frameCount++;
+    return false;
+}
+
+float NullPlatform::getFrameTime() {
+    return frameTime;
+}
+
+bool NullPlatform::isKeyDown(int key) const {
+    return key >= 0 && key < 512 && keysDown[key];
+}
+
+bool NullPlatform::isKeyPressed(int key) const {
+    if (autoStart && key == KEY_ENTER) {
+        return true;
+    }
+    return isKeyDown(key);
+}
+
+void NullPlatform::setKeyDown(int key, bool down) {
+    if (key >= 0 && key < 512) {
+        keysDown[key] = down;
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "raylib.h"
+
+// Receives key changes as the platform sees them, on the main thread
+class KeyListener {
+public:
+    virtual ~KeyListener() {}
+    // time is on Platform::getTime()'s clock
+    virtual void onKey(int key, bool down, double time) = 0;
+};
+
+// Window, input and frame timing. Game code talks to this interface instead
+// of raylib so the simulation can run without a window (see NullPlatform).
+class Platform {
+public:
+    virtual ~Platform() {}
+
+    virtual void openWindow(int width, int height, const char* title) = 0;
+    virtual void closeWindow() = 0;
+    virtual bool shouldClose() = 0;
+    virtual bool isHeadless() const = 0;
+    // Minimized or unfocused: nothing should run until it is back
+    virtual bool isSuspended() const = 0;
+    virtual bool isWindowResized() const = 0;
+    // Sleeps until there is input or timeout seconds have passed, then polls
+    // it. A negative timeout waits for input however long it takes. The wait
+    // does not count towards the next getFrameTime().
+    virtual void waitForInput(float timeout) = 0;
+
+    // Polls input now rather than at the end of the frame
+    virtual void pollInput() = 0;
+    // Delivers every key change to listener as it arrives, or stops with
+    // nullptr. Returns false when this platform cannot, and keys have to be
+    // polled instead.
+    virtual bool setKeyListener(KeyListener* listener) = 0;
+    // Hands key events waiting in the OS to the listener now. isKeyDown()
+    // and isKeyPressed() only see them after the next pollInput() or
+    // waitForInput(), as if they had arrived then.
+    virtual void pumpEvents() = 0;
+
+    virtual void setTargetFPS(int fps) = 0;
+    // Before openWindow() this asks for vsync when the window is created
+    virtual void setVsync(bool enabled) = 0;
+    // The current monitor's refresh rate in Hz
+    virtual int getRefreshRate() const = 0;
+    virtual float getFrameTime() = 0;
+    // Seconds since startup
+    virtual double getTime() const = 0;
+
+    virtual bool isKeyDown(int key) const = 0;
+    virtual bool isKeyPressed(int key) const = 0;
+};
+
+class RaylibPlatform : public Platform {
+private:
+    double frameStart;
+    bool vsync;
+    bool windowOpen;
+
+public:
+    RaylibPlatform();
+
+    void openWindow(int width, int height, const char* title) override;
+    void closeWindow() override;
+    bool shouldClose() override;
+    bool isHeadless() const override { return false; }
+    bool isSuspended() const override;
+    bool isWindowResized() const override;
+    void waitForInput(float timeout) override;
+    void pollInput() override;
+    bool setKeyListener(KeyListener* listener) override;
+    void pumpEvents() override;
+
+    void setTargetFPS(int fps) override;
+    void setVsync(bool enabled) override;
+    int getRefreshRate() const override;
+    float getFrameTime() override;
+    double getTime() const override;
+
+    bool isKeyDown(int key) const override;
+    bool isKeyPressed(int key) const override;
+};
+
+// Runs without a window. Every frame advances by a fixed step, ENTER reads as
+// pressed so the title and game over screens fall straight through to
+// gameplay, and the window "closes" once the frame limit is reached.
+class NullPlatform : public Platform {
+private:
+    float frameTime;
+    long long frameLimit;
+    long long frameCount;
+    bool autoStart;
+    bool keysDown[512];
+
+public:
+    NullPlatform();
+
+    void openWindow(int width, int height, const char* title) override;
+    void closeWindow() override;
+    bool shouldClose() override;
+    bool isHeadless() const override { return true; }
+    bool isSuspended() const override { return false; }
+    bool isWindowResized() const override { return false; }
+    void waitForInput(float timeout) override {}
+    void pollInput() override {}
+    bool setKeyListener(KeyListener* listener) override { return false; }
+    void pumpEvents() override {}
+
+    void setTargetFPS(int fps) override {}
+    void setVsync(bool enabled) override {}
+    int getRefreshRate() const override { return 60; }
+    float getFrameTime() override;
+    // Simulated: every frame so far took the fixed step
+    double getTime() const override { return frameCount * (double)frameTime; }
+
+    bool isKeyDown(int key) const override;
+    bool isKeyPressed(int key) const override;
+
+    void setFrameTime(float seconds) { frameTime = seconds; }
+    void setFrameLimit(long long frames) { frameLimit = frames; }
+    void setAutoStart(bool enabled) { autoStart = enabled; }
+    void setKeyDown(int key, bool down);
+    long long getFrameCount() const { return frameCount; }
+};
@@ -1,13 +1,15 @@
 #pragma once
 #include "raylib.h"
+#include <cmath>
 
 class GameManager;
+class SpriteBatch;
 
 class Player {
 private:
     Vector2 position;
+    Vector2 previousPosition;
     float speed;
-    Texture2D texture;
     float size;
     Rectangle hitbox;
     bool hit;
@@ -15,10 +17,10 @@ private:
 
 public:
     Player(Vector2 startPos, float moveSpeed, float playerSize);
-    ~Player();
 
     void update(float deltaTime);
-    void render() const;
+    void render(SpriteBatch& batch, float alpha) const;
+    void savePreviousPosition() { previousPosition = position; }
     void moveLeft(float deltaTime);
     void moveRight(float deltaTime);
 
@@ -31,15 +33,17 @@ public:
 };
 
 #include "GameManager.h"
+#include "TextureAtlas.h"
+#include "SpriteBatch.h"
 
 inline Player::Player(Vector2 startPos, float moveSpeed, float playerSize) :
     position(startPos),
+    previousPosition(startPos),
     speed(moveSpeed),
     size(playerSize),
     hit(false),
     hitTimer(0.0f)
 {
-    texture = LoadTexture("Resources/Cart.png");
     hitbox = Rectangle{
         position.x - size / 2,
         position.y - size / 2,
@@ -48,10 +52,6 @@ inline Player::Player(Vector2 startPos, float moveSpeed, float playerSize) :
     };
 }
 
-inline Player::~Player() {
-    UnloadTexture(texture);
-}
-
 inline void Player::update(float deltaTime) {
     if (hit) {
         hitTimer -= deltaTime;
@@ -63,16 +63,17 @@ inline void Player::update(float deltaTime) {
     hitbox.y = position.y - size / 2;
 }
 
-inline void Player::render() const {
+inline void Player::render(SpriteBatch& batch, float alpha) const {
     Color playerColor = hit ?
         Color{ 255, (unsigned char)(80 * (sinf(hitTimer * 30) * 0.5f + 0.5f)),
               (unsigned char)(80 * (sinf(hitTimer * 30) * 0.5f + 0.5f)), 255 } :
         WHITE;
 
-    DrawTexture(
-        texture,
-        position.x - texture.width / 2,
-        position.y - texture.height / 2,
+    const TextureAtlas* atlas = GameManager::getInstance()->getAtlas();
+    batch.draw(
+        SpriteId::CART,
+        previousPosition.x + (position.x - previousPosition.x) * alpha - atlas->getWidth(SpriteId::CART) / 2,
+        position.y - atlas->getHeight(SpriteId::CART) / 2,
         playerColor
     );
 }
@@ -94,6 +95,7 @@ inline void Player::moveRight(float deltaTime) {
 
 inline void Player::setPosition(Vector2 newPos) {
     position = newPos;
+    previousPosition = newPos;
     hitbox.x = position.x - size / 2;
     hitbox.y = position.y - size / 2;
 }
\ No newline at end of file
@@ -0,0 +1,237 @@
+#include "Profiler.h"
+
+#ifdef COLLECTDGEMS_PROFILER
+
+#include "Renderer.h"
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+static std::atomic<uint16_t> nextThreadIndex(1);
+static thread_local uint16_t threadIndex = 0;
+// Scopes on the simulation thread register while the main thread does too
+static std::mutex scopeMutex;
+
+static const float GRAPH_HEIGHT = 40.0f;
+static const float GRAPH_MAX_MS = 33.3f;
+
+Profiler::Profiler() :
+    writeIndex(0),
+    frameStartIndex(0),
+    scopeNames(),
+    scopeCount(0),
+    scopeHistory(),
+    frameHistory(),
+    historyHead(0),
+    historyCount(0),
+    counterNames(),
+    counterValues(),
+    counterCount(0),
+    epoch(std::chrono::steady_clock::now()),
+    lastFrameNs(0),
+    overlayVisible(false)
+{
+}
+
+// The first PROFILE_SCOPE can run on any thread
+Profiler* Profiler::getInstance() {
+    static Profiler instance;
+    return &instance;
+}
+
+// Called once per PROFILE_SCOPE site. Sites sharing a name share a slot.
+// The name is stored before the count grows, so readers that load the count
+// first only see names already set.
+int Profiler::registerScope(const char* name) {
+    std::lock_guard<std::mutex> lock(scopeMutex);
+    int count = scopeCount.load();
+    for (int i = 0; i < count; i++) {
+        if (strcmp(scopeNames[i], name) == 0) {
+            return i;
+        }
+    }
+    if (count >= MAX_SCOPES) {
+        return -1;
+    }
+    scopeNames[count] = name;
+    scopeCount.store(count + 1);
+    return count;
+}
+
+// Counters are looked up by name; the name must outlive the profiler.
+void Profiler::setCounter(const char* name, float value) {
+    for (int i = 0; i < counterCount; i++) {
+        if (counterNames[i] == name || strcmp(counterNames[i], name) == 0) {
+            counterValues[i] = value;
+            return;
+        }
+    }
+    if (counterCount < MAX_COUNTERS) {
+        counterNames[counterCount] = name;
+        counterValues[counterCount] = value;
+        counterCount++;
+    }
+}
+
+uint64_t Profiler::now() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::record(int scope, uint64_t startNs, uint64_t endNs) {
+    if (scope < 0) {
+        return;
+    }
+    if (threadIndex == 0) {
+        threadIndex = nextThreadIndex.fetch_add(1);
+    }
+    uint64_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    ProfileSlot& slot = events[index & (EVENT_CAPACITY - 1)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_release);
+    slot.durationNs.store(endNs - startNs, std::memory_order_release);
+    slot.scopeAndThread.store((uint32_t)scope | (uint32_t)threadIndex << 16, std::memory_order_release);
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+// Seqlock read: the sequence is checked again after the fields are copied,
+// in case a writer lapping the ring started on the slot meanwhile. A field
+// load that sees that writer's value also makes its zeroed sequence visible.
+int Profiler::readEvent(uint64_t index, ProfileEvent& event) const {
+    const ProfileSlot& slot = events[index & (EVENT_CAPACITY - 1)];
+    uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != index + 1) {
+        return sequence > index + 1 ? -1 : 0;
+    }
+    event.startNs = slot.startNs.load(std::memory_order_acquire);
+    event.durationNs = slot.durationNs.load(std::memory_order_acquire);
+    uint32_t scopeAndThread = slot.scopeAndThread.load(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+        return -1;
+    }
+    event.scope = (uint16_t)(scopeAndThread & 0xFFFF);
+    event.thread = (uint16_t)(scopeAndThread >> 16);
+    return 1;
+}
+
+// Folds the events recorded since the last call into this frame's per-scope
+// totals and records the frame time. Events still being written are left
+// for the next frame.
+void Profiler::endFrame() {
+    uint64_t end = writeIndex.load(std::memory_order_acquire);
+    uint64_t begin = frameStartIndex;
+    if (end - begin > EVENT_CAPACITY) {
+        begin = end - EVENT_CAPACITY;
+    }
+
+    float* totals = scopeHistory[historyHead];
+    for (int i = 0; i < MAX_SCOPES; i++) {
+        totals[i] = 0.0f;
+    }
+    uint64_t i = begin;
+    for (; i < end; i++) {
+        ProfileEvent event;
+        int result = readEvent(i, event);
+        if (result == 0) {
+            break;
+        }
+        if (result > 0) {
+            totals[event.scope] += event.durationNs / 1000000.0f;
+        }
+    }
+
+    uint64_t frameNs = now();
+    frameHistory[historyHead] = lastFrameNs != 0 ? (frameNs - lastFrameNs) / 1000000.0f : 0.0f;
+    lastFrameNs = frameNs;
+
+    historyHead = (historyHead + 1) % HISTORY_FRAMES;
+    if (historyCount < HISTORY_FRAMES) {
+        historyCount++;
+    }
+    frameStartIndex = i;
+}
+
+// min/avg/max over the last HISTORY_FRAMES frames, then a frame time graph
+// with one bar per frame, oldest on the left.
+void Profiler::renderOverlay(Renderer* renderer, int screenWidth) const {
+    const int panelWidth = 330;
+    const int lineHeight = 12;
+    int scopes = scopeCount.load();
+    int panelX = screenWidth - panelWidth - 10;
+    int panelHeight = (scopes + counterCount + 2) * lineHeight + (int)GRAPH_HEIGHT + 16;
+    renderer->drawRectangle(panelX, 10, panelWidth, panelHeight, Fade(BLACK, 0.75f));
+
+    Font font = {};
+    float x = (float)panelX + 6;
+    float y = 14;
+    renderer->drawText(font, "scope                      min    avg    max ms", Vector2{ x, y }, 10, 1, LIGHTGRAY);
+    y += lineHeight;
+
+    for (int scope = -1; scope < scopes; scope++) {
+        float minMs = 0.0f;
+        float maxMs = 0.0f;
+        float sumMs = 0.0f;
+        for (int i = 0; i < historyCount; i++) {
+            float ms = scope < 0 ? frameHistory[i] : scopeHistory[i][scope];
+            minMs = i == 0 || ms < minMs ? ms : minMs;
+            maxMs = ms > maxMs ? ms : maxMs;
+            sumMs += ms;
+        }
+        float avgMs = historyCount > 0 ? sumMs / historyCount : 0.0f;
+        const char* name = scope < 0 ? "frame" : scopeNames[scope];
+        renderer->drawText(font, TextFormat("%-24.24s %6.2f %6.2f %6.2f", name != nullptr ? name : "?", minMs, avgMs, maxMs),
+            Vector2{ x, y }, 10, 1, scope < 0 ? YELLOW : WHITE);
+        y += lineHeight;
+    }
+    for (int i = 0; i < counterCount; i++) {
+        renderer->drawText(font, TextFormat("%-24.24s %6.0f", counterNames[i], counterValues[i]),
+            Vector2{ x, y }, 10, 1, SKYBLUE);
+        y += lineHeight;
+    }
+
+    y += 4;
+    float barWidth = (float)(panelWidth - 12) / HISTORY_FRAMES;
+    for (int i = 0; i < historyCount; i++) {
+        int slot = (historyHead - historyCount + i + HISTORY_FRAMES) % HISTORY_FRAMES;
+        float ms = frameHistory[slot];
+        float height = ms / GRAPH_MAX_MS * GRAPH_HEIGHT;
+        if (height > GRAPH_HEIGHT) {
+            height = GRAPH_HEIGHT;
+        }
+        Color color = ms > 1000.0f / 60.0f + 1.0f ? RED : GREEN;
+        renderer->drawRectangle((int)(x + i * barWidth), (int)(y + GRAPH_HEIGHT - height),
+            barWidth > 1.0f ? (int)barWidth : 1, (int)height, color);
+    }
+}
+
+// Writes every event still in the ring in Chrome's trace_event format
+// (load it in chrome://tracing or ui.perfetto.dev).
+bool Profiler::writeChromeTrace(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        fprintf(stderr, "profiler: cannot write %s\n", path);
+        return false;
+    }
+    uint64_t end = writeIndex.load(std::memory_order_acquire);
+    uint64_t begin = end > EVENT_CAPACITY ? end - EVENT_CAPACITY : 0;
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (uint64_t i = begin; i < end; i++) {
+        ProfileEvent event;
+        if (readEvent(i, event) <= 0) {
+            continue;
+        }
+        const char* name = scopeNames[event.scope];
+        fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+            first ? "" : ",\n", name != nullptr ? name : "?", event.startNs / 1000.0,
+            event.durationNs / 1000.0, (unsigned)event.thread);
+        first = false;
+    }
+    fprintf(file, "\n");
+    fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+    bool ok = ferror(file) == 0;
+    return fclose(file) == 0 && ok;
+}
+
+#endif
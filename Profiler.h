@@ -0,0 +1,125 @@
+#pragma once
+
+// Scoped frame profiler. Build with COLLECTDGEMS_PROFILER defined (the CMake
+// option of the same name) to enable it; otherwise every macro below expands
+// to nothing and no profiler code is compiled in.
+//
+//   PROFILE_SCOPE("GameManager::update");   // times the enclosing block
+//   PROFILE_FRAME_END();                    // once per displayed frame
+//
+// Profiler::setCounter adds a named value to the overlay, e.g. a per-frame
+// count kept by some other system.
+
+#ifdef COLLECTDGEMS_PROFILER
+
+#include "raylib.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+class Renderer;
+
+struct ProfileEvent {
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint16_t scope;
+    uint16_t thread;
+};
+
+// One ring entry. sequence is the event's index plus one once its fields are
+// written, and zero while a writer is filling them in.
+struct ProfileSlot {
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> startNs;
+    std::atomic<uint64_t> durationNs;
+    std::atomic<uint32_t> scopeAndThread;
+};
+
+class Profiler {
+private:
+    static const int MAX_SCOPES = 32;
+    static const uint64_t EVENT_CAPACITY = 1 << 16;
+    static const int HISTORY_FRAMES = 120;
+    static const int MAX_COUNTERS = 8;
+
+    Profiler();
+
+    // Events from every thread land in one ring; a writer claims its slot
+    // with a single atomic increment and never waits. The simulation thread
+    // and job workers keep recording while the main thread reads, so readers
+    // only take slots whose sequence shows they are fully written.
+    ProfileSlot events[EVENT_CAPACITY];
+    std::atomic<uint64_t> writeIndex;
+    uint64_t frameStartIndex;
+
+    const char* scopeNames[MAX_SCOPES];
+    std::atomic<int> scopeCount;
+
+    // Per-scope time spent in each of the last HISTORY_FRAMES frames
+    float scopeHistory[HISTORY_FRAMES][MAX_SCOPES];
+    float frameHistory[HISTORY_FRAMES];
+    int historyHead;
+    int historyCount;
+
+    // Set from the main thread only
+    const char* counterNames[MAX_COUNTERS];
+    float counterValues[MAX_COUNTERS];
+    int counterCount;
+
+    std::chrono::steady_clock::time_point epoch;
+    uint64_t lastFrameNs;
+    bool overlayVisible;
+
+    // 1 if the event was read, 0 if its writer has not finished yet, -1 if
+    // the slot has since been reused for a newer event
+    int readEvent(uint64_t index, ProfileEvent& event) const;
+
+public:
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static Profiler* getInstance();
+
+    int registerScope(const char* name);
+    void record(int scope, uint64_t startNs, uint64_t endNs);
+    uint64_t now() const;
+
+    void setCounter(const char* name, float value);
+    void endFrame();
+    void toggleOverlay() { overlayVisible = !overlayVisible; }
+    bool isOverlayVisible() const { return overlayVisible; }
+    void renderOverlay(Renderer* renderer, int screenWidth) const;
+    bool writeChromeTrace(const char* path) const;
+};
+
+class ProfileScope {
+private:
+    int scope;
+    uint64_t startNs;
+
+public:
+    explicit ProfileScope(int scopeId) :
+        scope(scopeId),
+        startNs(Profiler::getInstance()->now())
+    {
+    }
+
+    ~ProfileScope() {
+        Profiler* profiler = Profiler::getInstance();
+        profiler->record(scope, startNs, profiler->now());
+    }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) \
+    static const int PROFILE_CONCAT(profileScopeId, __LINE__) = Profiler::getInstance()->registerScope(name); \
+    ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profileScopeId, __LINE__))
+#define PROFILE_FRAME_END() Profiler::getInstance()->endFrame()
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_FRAME_END()
+
+#endif
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Each system draws from its own stream, so adding a draw in one (say, a
+// particle effect) leaves every other system's sequence untouched.
+enum class RandomStream {
+    SPAWN_TYPE,
+    SPAWN_POSITION,
+    SPAWN_TIMING,
+    COUNT
+};
+
+// PCG32 (pcg-random.org): 64-bit state, 32-bit output. Generators seeded
+// with the same seed but different stream numbers produce unrelated
+// sequences.
+class Random {
+private:
+    uint64_t state;
+    uint64_t increment;
+
+public:
+    Random();
+    Random(uint64_t seed, uint64_t stream);
+
+    void seed(uint64_t seed, uint64_t stream);
+
+    uint32_t next();
+    // Fills values with the next count outputs, the same as count next() calls
+    void fill(uint32_t* values, size_t count);
+
+    // Maps a raw output onto [0, span) with one multiply. The bias is at most
+    // span / 2^32, far below anything the game could notice.
+    static uint32_t bounded(uint32_t value, uint32_t span) {
+        return (uint32_t)(((uint64_t)value * span) >> 32);
+    }
+};
+
+inline Random::Random() :
+    state(0),
+    increment(1)
+{
+    seed(0, 0);
+}
+
+inline Random::Random(uint64_t seedValue, uint64_t stream) :
+    state(0),
+    increment(1)
+{
+    seed(seedValue, stream);
+}
+
+inline void Random::seed(uint64_t seedValue, uint64_t stream) {
+    state = 0;
+    increment = (stream << 1) | 1;
+    next();
+    state += seedValue;
+    next();
+}
+
+inline uint32_t Random::next() {
+    uint64_t previous = state;
+    state = previous * 6364136223846793005ULL + increment;
+    uint32_t xorShifted = (uint32_t)(((previous >> 18) ^ previous) >> 27);
+    uint32_t rotation = (uint32_t)(previous >> 59);
+    return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+}
+
+inline void Random::fill(uint32_t* values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        values[i] = next();
+    }
+}
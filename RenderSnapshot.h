@@ -0,0 +1,42 @@
+#pragma once
+#include "raylib.h"
+#include "GameEvents.h"
+#include "FallingObjectPool.h"
+#include "ScoreSystem.h"
+#include "Player.h"
+#include <chrono>
+#include <vector>
+
+// Everything render() draws, copied out of the simulation after its ticks.
+// The renderer never looks at live game objects, so with a simulation thread
+// the two sides only meet in the TripleBuffer that hands these over.
+struct RenderSnapshot {
+    StateId state;
+    std::vector<ObjectSprite> objects;
+    Player player;
+    ScoreSnapshot score;
+    bool screenFlash;
+    float flashAlpha;
+    // Blend factor left over from the fixed-step loop when this was taken
+    float interpolationAlpha;
+    std::chrono::steady_clock::time_point publishedAt;
+    // When the oldest input these ticks acted on was sampled; the clock's
+    // epoch if they acted on none
+    std::chrono::steady_clock::time_point inputSampledAt;
+
+    explicit RenderSnapshot(size_t maxObjects);
+};
+
+inline RenderSnapshot::RenderSnapshot(size_t maxObjects) :
+    state(StateId::NONE),
+    objects(),
+    player(Vector2{ 0, 0 }, 0.0f, 0.0f),
+    score(),
+    screenFlash(false),
+    flashAlpha(0.0f),
+    interpolationAlpha(1.0f),
+    publishedAt(),
+    inputSampledAt()
+{
+    objects.reserve(maxObjects);
+}
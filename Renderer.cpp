@@ -0,0 +1,482 @@
+#include "Renderer.h"
+#include "TextLayout.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Matches RL_DEFAULT_BATCH_BUFFER_ELEMENTS on desktop OpenGL.
+static const int BATCH_QUAD_LIMIT = 8192;
+
+// Shapes are drawn with raylib's internal white texture, which never
+// collides with a real texture id.
+static const unsigned int SHAPES_TEXTURE_ID = 0xFFFFFFFFu;
+
+Renderer::Renderer() :
+    frameStats(),
+    lastFrameStats(),
+    boundTexture(0),
+    quadsInBatch(0),
+    logicalWidth(1),
+    logicalHeight(1),
+    resolutionScale(1.0f)
+{
+}
+
+void Renderer::resetFrameStats() {
+    frameStats = RenderStats{};
+    boundTexture = 0;
+    quadsInBatch = 0;
+}
+
+// Layers are drawn before beginFrame(), so the count restarts here rather
+// than there and they land in the frame that shows them
+void Renderer::finishFrameStats() {
+    lastFrameStats = frameStats;
+    resetFrameStats();
+}
+
+void Renderer::countQuads(unsigned int textureId, int quads) {
+    if (frameStats.drawCalls == 0 || textureId != boundTexture) {
+        if (frameStats.drawCalls > 0) {
+            frameStats.textureSwitches++;
+        }
+        frameStats.drawCalls++;
+        boundTexture = textureId;
+        quadsInBatch = 0;
+    }
+    quadsInBatch += quads;
+    while (quadsInBatch > BATCH_QUAD_LIMIT) {
+        frameStats.drawCalls++;
+        quadsInBatch -= BATCH_QUAD_LIMIT;
+    }
+    frameStats.quads += quads;
+}
+
+static int countGlyphs(const char* text) {
+    int glyphs = 0;
+    for (const char* c = text; *c != '\0'; c++) {
+        if (*c != ' ' && *c != '\n') {
+            glyphs++;
+        }
+    }
+    return glyphs;
+}
+
+Texture2D RaylibRenderer::loadTexture(const char* fileName) {
+    return LoadTexture(fileName);
+}
+
+Texture2D RaylibRenderer::loadTextureFromImage(Image image) {
+    return LoadTextureFromImage(image);
+}
+
+void RaylibRenderer::unloadTexture(Texture2D texture) {
+    UnloadTexture(texture);
+}
+
+Font RaylibRenderer::loadFont(const char* fileName) {
+    return LoadFont(fileName);
+}
+
+void RaylibRenderer::unloadFont(Font font) {
+    UnloadFont(font);
+}
+
+// Same steps as LoadFont() with its default size and charset, minus the
+// texture upload.
+DecodedFont RaylibRenderer::decodeFont(const char* fileName) {
+    DecodedFont decoded = {};
+    int dataSize = 0;
+    unsigned char* data = LoadFileData(fileName, &dataSize);
+    if (data == nullptr) {
+        return decoded;
+    }
+
+    Font& font = decoded.font;
+    font.baseSize = 32;
+    font.glyphCount = 95;
+    font.glyphs = LoadFontData(data, dataSize, font.baseSize, nullptr, font.glyphCount, FONT_DEFAULT);
+    UnloadFileData(data);
+    if (font.glyphs == nullptr) {
+        font.glyphCount = 0;
+        return decoded;
+    }
+
+    font.glyphPadding = 4;
+    decoded.atlas = GenImageFontAtlas(font.glyphs, &font.recs, font.glyphCount, font.baseSize, font.glyphPadding, 0);
+    for (int i = 0; i < font.glyphCount; i++) {
+        UnloadImage(font.glyphs[i].image);
+        font.glyphs[i].image = ImageFromImage(decoded.atlas, font.recs[i]);
+    }
+    return decoded;
+}
+
+Font RaylibRenderer::uploadFont(DecodedFont decoded) {
+    if (decoded.atlas.data != nullptr) {
+        decoded.font.texture = LoadTextureFromImage(decoded.atlas);
+    }
+    return decoded.font;
+}
+
+Image RaylibRenderer::loadImage(const char* fileName) {
+    Image image = LoadImage(fileName);
+    if (image.data != nullptr) {
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+    return image;
+}
+
+Image RaylibRenderer::genImage(int width, int height) {
+    return GenImageColor(width, height, BLANK);
+}
+
+void RaylibRenderer::drawImage(Image* dst, Image src, int posX, int posY) {
+    ImageDraw(dst, src,
+        Rectangle{ 0, 0, (float)src.width, (float)src.height },
+        Rectangle{ (float)posX, (float)posY, (float)src.width, (float)src.height },
+        WHITE);
+}
+
+void RaylibRenderer::unloadImage(Image image) {
+    UnloadImage(image);
+}
+
+RaylibRenderer::RaylibRenderer() :
+    frameTarget()
+{
+}
+
+// The largest area of the window with the scene's aspect ratio, centered
+Rectangle RaylibRenderer::getWindowViewport() const {
+    float windowWidth = (float)GetScreenWidth();
+    float windowHeight = (float)GetScreenHeight();
+    float fit = fminf(windowWidth / logicalWidth, windowHeight / logicalHeight);
+    float width = logicalWidth * fit;
+    float height = logicalHeight * fit;
+    return Rectangle{ (windowWidth - width) / 2, (windowHeight - height) / 2, width, height };
+}
+
+void RaylibRenderer::getFrameSize(int& width, int& height) const {
+    Rectangle viewport = getWindowViewport();
+    width = (int)(viewport.width * resolutionScale + 0.5f);
+    height = (int)(viewport.height * resolutionScale + 0.5f);
+    width = width > 1 ? width : 1;
+    height = height > 1 ? height : 1;
+}
+
+// Sizes target to the frame resolution and starts drawing into it in logical
+// units
+void RaylibRenderer::beginTarget(RenderTexture2D& target, Color clearColor) {
+    int width = 0;
+    int height = 0;
+    getFrameSize(width, height);
+    // Only a resize or a scale step gets here, not every frame
+    if (width != target.texture.width || height != target.texture.height) {
+        if (target.id != 0) {
+            UnloadRenderTexture(target);
+        }
+        target = LoadRenderTexture(width, height);
+        SetTextureFilter(target.texture, TEXTURE_FILTER_POINT);
+    }
+
+    breakBatch();
+    BeginTextureMode(target);
+    ClearBackground(clearColor);
+    Camera2D camera = { Vector2{ 0, 0 }, Vector2{ 0, 0 }, 0.0f, (float)width / logicalWidth };
+    BeginMode2D(camera);
+}
+
+void RaylibRenderer::beginFrame(Color clearColor) {
+    beginTarget(frameTarget, clearColor);
+}
+
+void RaylibRenderer::endFrame() {
+    EndMode2D();
+    EndTextureMode();
+    breakBatch();
+
+    BeginDrawing();
+    ClearBackground(BLACK);
+    // Render textures are stored bottom-up, hence the negative source height
+    Rectangle source = { 0, 0, (float)frameTarget.texture.width, -(float)frameTarget.texture.height };
+    countQuads(frameTarget.texture.id, 1);
+    DrawTexturePro(frameTarget.texture, source, getWindowViewport(), Vector2{ 0, 0 }, 0.0f, WHITE);
+    EndDrawing();
+    finishFrameStats();
+}
+
+void RaylibRenderer::unloadFrameTarget() {
+    if (frameTarget.id != 0) {
+        UnloadRenderTexture(frameTarget);
+        frameTarget = RenderTexture2D{};
+    }
+}
+
+void RaylibRenderer::beginLayer(RenderLayer& layer) {
+    beginTarget(layer.target, BLANK);
+}
+
+void RaylibRenderer::endLayer() {
+    EndMode2D();
+    EndTextureMode();
+    breakBatch();
+}
+
+// Layer and frame share a resolution, so this is a one-to-one pixel copy
+void RaylibRenderer::drawLayer(const RenderLayer& layer) {
+    Rectangle source = { 0, 0, (float)layer.target.texture.width, -(float)layer.target.texture.height };
+    countQuads(layer.target.texture.id, 1);
+    DrawTexturePro(layer.target.texture, source,
+        Rectangle{ 0, 0, (float)logicalWidth, (float)logicalHeight }, Vector2{ 0, 0 }, 0.0f, WHITE);
+}
+
+bool RaylibRenderer::isLayerCurrent(const RenderLayer& layer) const {
+    int width = 0;
+    int height = 0;
+    getFrameSize(width, height);
+    return layer.target.id != 0 && layer.target.texture.width == width && layer.target.texture.height == height;
+}
+
+void RaylibRenderer::unloadLayer(RenderLayer& layer) {
+    if (layer.target.id != 0) {
+        UnloadRenderTexture(layer.target);
+    }
+    layer = RenderLayer{};
+}
+
+void RaylibRenderer::drawTexture(Texture2D texture, int posX, int posY, Color tint) {
+    countQuads(texture.id, 1);
+    DrawTexture(texture, posX, posY, tint);
+}
+
+void RaylibRenderer::drawTexturePro(Texture2D texture, Rectangle source, Rectangle dest,
+    Vector2 origin, float rotation, Color tint) {
+    countQuads(texture.id, 1);
+    DrawTexturePro(texture, source, dest, origin, rotation, tint);
+}
+
+void RaylibRenderer::drawRectangle(int posX, int posY, int width, int height, Color color) {
+    countQuads(SHAPES_TEXTURE_ID, 1);
+    DrawRectangle(posX, posY, width, height, color);
+}
+
+void RaylibRenderer::drawText(Font font, const char* text, Vector2 position,
+    float fontSize, float spacing, Color tint) {
+    countQuads(font.texture.id, countGlyphs(text));
+    DrawTextEx(font, text, position, fontSize, spacing, tint);
+}
+
+Vector2 RaylibRenderer::measureText(Font font, const char* text, float fontSize, float spacing) {
+    return MeasureTextEx(font, text, fontSize, spacing);
+}
+
+// Same glyph placement as DrawTextEx/DrawTextCodepoint, recorded instead of
+// drawn. Line spacing matches raylib's default of 2.
+void RaylibRenderer::layoutText(Font font, const char* text, float fontSize, float spacing, TextLayout& layout) {
+    if (font.texture.id == 0) {
+        font = GetFontDefault();
+    }
+    Vector2 size = MeasureTextEx(font, text, fontSize, spacing);
+    layout.width = size.x;
+    layout.height = size.y;
+    layout.quads.clear();
+
+    float scale = fontSize / font.baseSize;
+    float padding = (float)font.glyphPadding;
+    float offsetX = 0.0f;
+    float offsetY = 0.0f;
+    for (int i = 0; text[i] != '\0';) {
+        int byteCount = 0;
+        int codepoint = GetCodepointNext(&text[i], &byteCount);
+        int index = GetGlyphIndex(font, codepoint);
+        i += byteCount;
+
+        if (codepoint == '\n') {
+            offsetY += fontSize + 2.0f;
+            offsetX = 0.0f;
+            continue;
+        }
+        const Rectangle& rec = font.recs[index];
+        const GlyphInfo& glyph = font.glyphs[index];
+        if (codepoint != ' ' && codepoint != '\t') {
+            GlyphQuad quad;
+            quad.source = Rectangle{ rec.x - padding, rec.y - padding,
+                rec.width + 2.0f * padding, rec.height + 2.0f * padding };
+            quad.dest = Rectangle{ offsetX + (glyph.offsetX - padding) * scale,
+                offsetY + (glyph.offsetY - padding) * scale,
+                (rec.width + 2.0f * padding) * scale, (rec.height + 2.0f * padding) * scale };
+            layout.quads.push_back(quad);
+        }
+        offsetX += (glyph.advanceX == 0 ? rec.width : (float)glyph.advanceX) * scale + spacing;
+    }
+}
+
+void RaylibRenderer::drawTextLayout(Font font, const TextLayout& layout, Vector2 position, Color tint) {
+    if (font.texture.id == 0) {
+        font = GetFontDefault();
+    }
+    countQuads(font.texture.id, (int)layout.quads.size());
+    for (const GlyphQuad& quad : layout.quads) {
+        Rectangle dest = { position.x + quad.dest.x, position.y + quad.dest.y, quad.dest.width, quad.dest.height };
+        DrawTexturePro(font.texture, quad.source, dest, Vector2{ 0, 0 }, 0.0f, tint);
+    }
+}
+
+NullRenderer::NullRenderer() :
+    nextTextureId(1)
+{
+}
+
+// Only the IHDR chunk is read: width and height are big-endian at offset 16.
+static bool readPngSize(const char* fileName, int* width, int* height) {
+    FILE* file = fopen(fileName, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    unsigned char header[24];
+    size_t read = fread(header, 1, sizeof(header), file);
+    fclose(file);
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (read != sizeof(header) || memcmp(header, signature, sizeof(signature)) != 0) {
+        return false;
+    }
+    *width = (header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19];
+    *height = (header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23];
+    return true;
+}
+
+Texture2D NullRenderer::loadTexture(const char* fileName) {
+    return loadTextureFromImage(loadImage(fileName));
+}
+
+Texture2D NullRenderer::loadTextureFromImage(Image image) {
+    Texture2D texture = {};
+    texture.id = nextTextureId++;
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.mipmaps = 1;
+    texture.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    return texture;
+}
+
+void NullRenderer::unloadTexture(Texture2D texture) {
+}
+
+Font NullRenderer::loadFont(const char* fileName) {
+    Font font = {};
+    font.baseSize = 16;
+    return font;
+}
+
+void NullRenderer::unloadFont(Font font) {
+}
+
+DecodedFont NullRenderer::decodeFont(const char* fileName) {
+    DecodedFont decoded = {};
+    decoded.font = loadFont(fileName);
+    return decoded;
+}
+
+Font NullRenderer::uploadFont(DecodedFont decoded) {
+    return decoded.font;
+}
+
+// Null images carry a size but no pixels.
+Image NullRenderer::loadImage(const char* fileName) {
+    Image image = {};
+    if (!readPngSize(fileName, &image.width, &image.height)) {
+        image.width = 16;
+        image.height = 16;
+    }
+    image.mipmaps = 1;
+    image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    return image;
+}
+
+Image NullRenderer::genImage(int width, int height) {
+    Image image = {};
+    image.width = width;
+    image.height = height;
+    image.mipmaps = 1;
+    image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    return image;
+}
+
+void NullRenderer::drawImage(Image* dst, Image src, int posX, int posY) {
+}
+
+void NullRenderer::unloadImage(Image image) {
+}
+
+void NullRenderer::beginFrame(Color clearColor) {
+}
+
+void NullRenderer::endFrame() {
+    finishFrameStats();
+}
+
+void NullRenderer::beginLayer(RenderLayer& layer) {
+    if (layer.target.id == 0) {
+        layer.target.id = nextTextureId++;
+        layer.target.texture.id = nextTextureId++;
+        layer.target.texture.width = logicalWidth;
+        layer.target.texture.height = logicalHeight;
+    }
+    breakBatch();
+}
+
+void NullRenderer::endLayer() {
+    breakBatch();
+}
+
+void NullRenderer::drawLayer(const RenderLayer& layer) {
+    countQuads(layer.target.texture.id, 1);
+}
+
+void NullRenderer::unloadLayer(RenderLayer& layer) {
+    layer = RenderLayer{};
+}
+
+void NullRenderer::drawTexture(Texture2D texture, int posX, int posY, Color tint) {
+    countQuads(texture.id, 1);
+}
+
+void NullRenderer::drawTexturePro(Texture2D texture, Rectangle source, Rectangle dest,
+    Vector2 origin, float rotation, Color tint) {
+    countQuads(texture.id, 1);
+}
+
+void NullRenderer::drawRectangle(int posX, int posY, int width, int height, Color color) {
+    countQuads(SHAPES_TEXTURE_ID, 1);
+}
+
+void NullRenderer::drawText(Font font, const char* text, Vector2 position,
+    float fontSize, float spacing, Color tint) {
+    countQuads(font.texture.id, countGlyphs(text));
+}
+
+// Fixed-advance approximation, close enough for centering maths.
+Vector2 NullRenderer::measureText(Font font, const char* text, float fontSize, float spacing) {
+    size_t length = strlen(text);
+    return Vector2{ length * (fontSize * 0.5f + spacing), fontSize };
+}
+
+void NullRenderer::layoutText(Font font, const char* text, float fontSize, float spacing, TextLayout& layout) {
+    Vector2 size = measureText(font, text, fontSize, spacing);
+    layout.width = size.x;
+    layout.height = size.y;
+    layout.quads.clear();
+
+    float advance = fontSize * 0.5f + spacing;
+    for (int i = 0; text[i] != '\0'; i++) {
+        if (text[i] != ' ' && text[i] != '\n') {
+            layout.quads.push_back(GlyphQuad{ Rectangle{ 0, 0, 0, 0 },
+                Rectangle{ i * advance, 0, fontSize * 0.5f, fontSize } });
+        }
+    }
+}
+
+void NullRenderer::drawTextLayout(Font font, const TextLayout& layout, Vector2 position, Color tint) {
+    countQuads(font.texture.id, (int)layout.quads.size());
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include "raylib.h"
+
+struct TextLayout;
+
+// A font whose glyphs are rasterized into an atlas image but not yet uploaded.
+struct DecodedFont {
+    Font font;
+    Image atlas;
+};
+
+// Per-frame submission counters. drawCalls estimates the GPU draw calls
+// raylib ends up issuing: its batch is broken by every texture change and
+// whenever the batch buffer fills up.
+struct RenderStats {
+    int drawCalls;
+    int quads;
+    int textureSwitches;
+};
+
+// A full-screen texture for content that rarely changes. It is drawn once
+// and then composited with a single quad; key records what it was drawn for.
+struct RenderLayer {
+    RenderTexture2D target;
+    unsigned long long key;
+    bool valid;
+};
+
+// Texture/font loading and 2D drawing. NullRenderer keeps real texture sizes
+// (read from the PNG header) so layout code behaves the same without a GPU.
+// Everything is drawn in logical units; how many pixels that becomes is up
+// to the backend.
+class Renderer {
+protected:
+    RenderStats frameStats;
+    RenderStats lastFrameStats;
+    unsigned int boundTexture;
+    int quadsInBatch;
+
+    int logicalWidth;
+    int logicalHeight;
+    float resolutionScale;
+
+    void resetFrameStats();
+    void finishFrameStats();
+    void countQuads(unsigned int textureId, int quads);
+    // Switching render targets flushes raylib's batch
+    void breakBatch() { boundTexture = 0; quadsInBatch = 0; }
+
+public:
+    Renderer();
+    virtual ~Renderer() {}
+
+    virtual Texture2D loadTexture(const char* fileName) = 0;
+    virtual Texture2D loadTextureFromImage(Image image) = 0;
+    virtual void unloadTexture(Texture2D texture) = 0;
+    virtual Font loadFont(const char* fileName) = 0;
+    virtual void unloadFont(Font font) = 0;
+    // decodeFont only touches CPU memory, so it may run on a worker thread.
+    // uploadFont creates the texture and must run on the main thread; the
+    // atlas image still belongs to the caller afterwards.
+    virtual DecodedFont decodeFont(const char* fileName) = 0;
+    virtual Font uploadFont(DecodedFont decoded) = 0;
+
+    virtual Image loadImage(const char* fileName) = 0;
+    virtual Image genImage(int width, int height) = 0;
+    virtual void drawImage(Image* dst, Image src, int posX, int posY) = 0;
+    virtual void unloadImage(Image image) = 0;
+
+    virtual void beginFrame(Color clearColor) = 0;
+    virtual void endFrame() = 0;
+    // Frees anything beginFrame() created. Call while the window is still open.
+    virtual void unloadFrameTarget() {}
+
+    // Layers are drawn between frames, never inside beginFrame()/endFrame(),
+    // at the resolution frames are currently drawn at. A layer stops being
+    // current when that resolution changes and has to be drawn again.
+    virtual void beginLayer(RenderLayer& layer) = 0;
+    virtual void endLayer() = 0;
+    virtual void drawLayer(const RenderLayer& layer) = 0;
+    virtual bool isLayerCurrent(const RenderLayer& layer) const = 0;
+    virtual void unloadLayer(RenderLayer& layer) = 0;
+
+    virtual void drawTexture(Texture2D texture, int posX, int posY, Color tint) = 0;
+    virtual void drawTexturePro(Texture2D texture, Rectangle source, Rectangle dest,
+        Vector2 origin, float rotation, Color tint) = 0;
+    virtual void drawRectangle(int posX, int posY, int width, int height, Color color) = 0;
+    virtual void drawText(Font font, const char* text, Vector2 position,
+        float fontSize, float spacing, Color tint) = 0;
+    virtual Vector2 measureText(Font font, const char* text, float fontSize, float spacing) = 0;
+    virtual void layoutText(Font font, const char* text, float fontSize, float spacing, TextLayout& layout) = 0;
+    virtual void drawTextLayout(Font font, const TextLayout& layout, Vector2 position, Color tint) = 0;
+
+    const RenderStats& getLastFrameStats() const { return lastFrameStats; }
+
+    void setLogicalSize(int width, int height) { logicalWidth = width; logicalHeight = height; }
+    // Fraction of the window's resolution the scene is rendered at, 0 to 1
+    void setResolutionScale(float scale) { resolutionScale = scale; }
+    float getResolutionScale() const { return resolutionScale; }
+};
+
+// Draws the scene into an offscreen target at the logical size times the
+// window's scale times the resolution scale, then stretches it over the
+// window with point filtering so pixel art stays sharp. The window may be
+// resized freely; the scene is letterboxed to keep its aspect ratio.
+class RaylibRenderer : public Renderer {
+private:
+    RenderTexture2D frameTarget;
+
+    Rectangle getWindowViewport() const;
+    void getFrameSize(int& width, int& height) const;
+    void beginTarget(RenderTexture2D& target, Color clearColor);
+
+public:
+    RaylibRenderer();
+
+    Texture2D loadTexture(const char* fileName) override;
+    Texture2D loadTextureFromImage(Image image) override;
+    void unloadTexture(Texture2D texture) override;
+    Font loadFont(const char* fileName) override;
+    void unloadFont(Font font) override;
+    DecodedFont decodeFont(const char* fileName) override;
+    Font uploadFont(DecodedFont decoded) override;
+
+    Image loadImage(const char* fileName) override;
+    Image genImage(int width, int height) override;
+    void drawImage(Image* dst, Image src, int posX, int posY) override;
+    void unloadImage(Image image) override;
+
+    void beginFrame(Color clearColor) override;
+    void endFrame() override;
+    void unloadFrameTarget() override;
+
+    void beginLayer(RenderLayer& layer) override;
+    void endLayer() override;
+    void drawLayer(const RenderLayer& layer) override;
+    bool isLayerCurrent(const RenderLayer& layer) const override;
+    void unloadLayer(RenderLayer& layer) override;
+
+    void drawTexture(Texture2D texture, int posX, int posY, Color tint) override;
+    void drawTexturePro(Texture2D texture, Rectangle source, Rectangle dest,
+        Vector2 origin, float rotation, Color tint) override;
+    void drawRectangle(int posX, int posY, int width, int height, Color color) override;
+    void drawText(Font font, const char* text, Vector2 position,
+        float fontSize, float spacing, Color tint) override;
+    Vector2 measureText(Font font, const char* text, float fontSize, float spacing) override;
+    void layoutText(Font font, const char* text, float fontSize, float spacing, TextLayout& layout) override;
+    void drawTextLayout(Font font, const TextLayout& layout, Vector2 position, Color tint) override;
+};
+
+class NullRenderer : public Renderer {
+private:
+    unsigned int nextTextureId;
+
+public:
+    NullRenderer();
+
+    Texture2D loadTexture(const char* fileName) override;
+    Texture2D loadTextureFromImage(Image image) override;
+    void unloadTexture(Texture2D texture) override;
+    Font loadFont(const char* fileName) override;
+    void unloadFont(Font font) override;
+    DecodedFont decodeFont(const char* fileName) override;
+    Font uploadFont(DecodedFont decoded) override;
+
+    Image loadImage(const char* fileName) override;
+    Image genImage(int width, int height) override;
+    void drawImage(Image* dst, Image src, int posX, int posY) override;
+    void unloadImage(Image image) override;
+
+    void beginFrame(Color clearColor) override;
+    void endFrame() override;
+
+    void beginLayer(RenderLayer& layer) override;
+    void endLayer() override;
+    void drawLayer(const RenderLayer& layer) override;
+    bool isLayerCurrent(const RenderLayer& layer) const override { return layer.target.id != 0; }
+    void unloadLayer(RenderLayer& layer) override;
+
+    void drawTexture(Texture2D texture, int posX, int posY, Color tint) override;
+    void drawTexturePro(Texture2D texture, Rectangle source, Rectangle dest,
+        Vector2 origin, float rotation, Color tint) override;
+    void drawRectangle(int posX, int posY, int width, int height, Color color) override;
+    void drawText(Font font, const char* text, Vector2 position,
+        float fontSize, float spacing, Color tint) override;
+    Vector2 measureText(Font font, const char* text, float fontSize, float spacing) override;
+    void layoutText(Font font, const char* text, float fontSize, float spacing, TextLayout& layout) override;
+    void drawTextLayout(Font font, const TextLayout& layout, Vector2 position, Color tint) override;
+};
@@ -0,0 +1,169 @@
+#include "Replay.h"
+#include <cstring>
+
+static const char REPLAY_MAGIC[4] = { 'C', 'D', 'G', 'R' };
+
+static bool isSameInput(const InputFrame& a, const InputFrame& b) {
+    return a.left == b.left && a.right == b.right && a.enter == b.enter;
+}
+
+ReplayRecorder::ReplayRecorder() :
+    file(nullptr),
+    runInput{ 0, 0, false },
+    runFrameTime(0.0f),
+    runLength(0),
+    ticks(0)
+{
+}
+
+ReplayRecorder::~ReplayRecorder() {
+    close();
+}
+
+bool ReplayRecorder::open(const char* path, uint32_t seed, uint32_t spawnTableHash) {
+    close();
+    file = fopen(path, "wb");
+    if (file == nullptr) {
+        fprintf(stderr, "replay: cannot write %s\n", path);
+        return false;
+    }
+    ReplayHeader header = { ReplayHeader::VERSION, seed, spawnTableHash };
+    fwrite(REPLAY_MAGIC, 1, sizeof(REPLAY_MAGIC), file);
+    fwrite(&header.version, sizeof(header.version), 1, file);
+    fwrite(&header.seed, sizeof(header.seed), 1, file);
+    fwrite(&header.spawnTableHash, sizeof(header.spawnTableHash), 1, file);
+    runLength = 0;
+    ticks = 0;
+    return true;
+}
+
+void ReplayRecorder::record(const InputFrame& frame, float deltaTime) {
+    if (file == nullptr) {
+        return;
+    }
+    // Frame times are compared bit for bit so playback gets the exact float
+    bool sameRun = runLength > 0 && isSameInput(frame, runInput) &&
+        memcmp(&deltaTime, &runFrameTime, sizeof(float)) == 0 && runLength < UINT32_MAX;
+    if (!sameRun) {
+        writeRun();
+        runInput = frame;
+        runFrameTime = deltaTime;
+    }
+    runLength++;
+    ticks++;
+}
+
+void ReplayRecorder::writeRun() {
+    if (runLength == 0) {
+        return;
+    }
+    uint8_t enter = runInput.enter ? 1 : 0;
+    fwrite(&runInput.left, sizeof(runInput.left), 1, file);
+    fwrite(&runInput.right, sizeof(runInput.right), 1, file);
+    fwrite(&enter, sizeof(enter), 1, file);
+    fwrite(&runFrameTime, sizeof(runFrameTime), 1, file);
+    fwrite(&runLength, sizeof(runLength), 1, file);
+    runLength = 0;
+}
+
+void ReplayRecorder::close() {
+    if (file == nullptr) {
+        return;
+    }
+    writeRun();
+    fclose(file);
+    file = nullptr;
+}
+
+ReplayPlayer::ReplayPlayer() :
+    file(nullptr),
+    header{ 0, 0, 0 },
+    runInput{ 0, 0, false },
+    runFrameTime(0.0f),
+    runRemaining(0),
+    ticks(0),
+    finished(true)
+{
+}
+
+ReplayPlayer::~ReplayPlayer() {
+    close();
+}
+
+bool ReplayPlayer::open(const char* path) {
+    close();
+    file = fopen(path, "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "replay: cannot read %s\n", path);
+        return false;
+    }
+    char magic[4];
+    bool valid = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+        memcmp(magic, REPLAY_MAGIC, sizeof(magic)) == 0 &&
+        fread(&header.version, sizeof(header.version), 1, file) == 1 &&
+        fread(&header.seed, sizeof(header.seed), 1, file) == 1 &&
+        fread(&header.spawnTableHash, sizeof(header.spawnTableHash), 1, file) == 1;
+    if (!valid || header.version < ReplayHeader::OLDEST_VERSION || header.version > ReplayHeader::VERSION) {
+        fprintf(stderr, "replay: %s is not a version %u to %u replay\n", path,
+            ReplayHeader::OLDEST_VERSION, ReplayHeader::VERSION);
+        close();
+        return false;
+    }
+    runRemaining = 0;
+    ticks = 0;
+    finished = false;
+    advance();
+    return true;
+}
+
+bool ReplayPlayer::readRun() {
+    bool valid;
+    if (header.version == 4) {
+        uint8_t bits;
+        valid = fread(&bits, sizeof(bits), 1, file) == 1;
+        runInput.left = (bits & 1) != 0 ? InputFrame::WHOLE_TICK : 0;
+        runInput.right = (bits & 2) != 0 ? InputFrame::WHOLE_TICK : 0;
+        runInput.enter = (bits & 4) != 0;
+    }
+    else {
+        uint8_t enter;
+        valid = fread(&runInput.left, sizeof(runInput.left), 1, file) == 1 &&
+            fread(&runInput.right, sizeof(runInput.right), 1, file) == 1 &&
+            fread(&enter, sizeof(enter), 1, file) == 1;
+        runInput.enter = enter != 0;
+    }
+    return valid &&
+        fread(&runFrameTime, sizeof(runFrameTime), 1, file) == 1 &&
+        fread(&runRemaining, sizeof(runRemaining), 1, file) == 1;
+}
+
+// Reads ahead to the next non-empty run, so isFinished() turns true as soon
+// as the last recorded tick has been handed out.
+void ReplayPlayer::advance() {
+    while (runRemaining == 0) {
+        if (!readRun()) {
+            finished = true;
+            return;
+        }
+    }
+}
+
+bool ReplayPlayer::next(InputFrame& frame, float& deltaTime) {
+    if (finished) {
+        return false;
+    }
+    frame = runInput;
+    deltaTime = runFrameTime;
+    runRemaining--;
+    ticks++;
+    advance();
+    return true;
+}
+
+void ReplayPlayer::close() {
+    if (file != nullptr) {
+        fclose(file);
+        file = nullptr;
+    }
+    finished = true;
+}
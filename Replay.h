@@ -0,0 +1,72 @@
+#pragma once
+#include "InputFrame.h"
+#include <cstdint>
+#include <cstdio>
+
+// Replay file layout (little endian):
+//   header: "CDGR", uint32 version, uint32 random seed, uint32 spawn table hash
+//   runs:   uint16 left held, uint16 right held, uint8 enter, float32 frame
+//           time, uint32 tick count
+// Consecutive ticks with the same input and frame time share one run, so a
+// fixed-rate session with a few key changes stays a few kilobytes. Version 4
+// runs start with one byte of input bits instead (1 left, 2 right, 4 enter),
+// a held key counting for the whole tick; those still play back.
+struct ReplayHeader {
+    static const uint32_t VERSION = 5;
+    static const uint32_t OLDEST_VERSION = 4;
+
+    uint32_t version;
+    uint32_t seed;
+    uint32_t spawnTableHash;
+};
+
+class ReplayRecorder {
+private:
+    FILE* file;
+    InputFrame runInput;
+    float runFrameTime;
+    uint32_t runLength;
+    unsigned long long ticks;
+
+    void writeRun();
+
+public:
+    ReplayRecorder();
+    ~ReplayRecorder();
+
+    bool open(const char* path, uint32_t seed, uint32_t spawnTableHash);
+    void record(const InputFrame& frame, float deltaTime);
+    void close();
+
+    bool isOpen() const { return file != nullptr; }
+    unsigned long long getTickCount() const { return ticks; }
+};
+
+class ReplayPlayer {
+private:
+    FILE* file;
+    ReplayHeader header;
+    InputFrame runInput;
+    float runFrameTime;
+    uint32_t runRemaining;
+    unsigned long long ticks;
+    bool finished;
+
+    bool readRun();
+    void advance();
+
+public:
+    ReplayPlayer();
+    ~ReplayPlayer();
+
+    bool open(const char* path);
+    // Fills in the next tick's input and frame time. Returns false once the
+    // recording has run out.
+    bool next(InputFrame& frame, float& deltaTime);
+    void close();
+
+    uint32_t getSeed() const { return header.seed; }
+    uint32_t getSpawnTableHash() const { return header.spawnTableHash; }
+    bool isFinished() const { return finished; }
+    unsigned long long getTickCount() const { return ticks; }
+};
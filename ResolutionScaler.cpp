@@ -0,0 +1,50 @@
+#include "ResolutionScaler.h"
+
+static const float MIN_SCALE = 0.5f;
+static const float MAX_SCALE = 1.0f;
+static const float SCALE_STEP = 0.125f;
+
+// Averages over roughly the last ten frames
+static const float SMOOTHING = 0.1f;
+// Jitter under this much over budget is not worth a visible drop
+static const float OVER_BUDGET_RATIO = 1.15f;
+// One long stall (loading, a window drag) should not count as many slow frames
+static const float MAX_SAMPLE_RATIO = 2.0f;
+
+static const int RAISE_DELAY_FRAMES = 120;
+static const int MAX_RAISE_DELAY_FRAMES = 1920;
+
+ResolutionScaler::ResolutionScaler() :
+    scale(MAX_SCALE),
+    averageFrameTime(0.0f),
+    steadyFrames(0),
+    raiseDelay(RAISE_DELAY_FRAMES),
+    framesSinceRaise(MAX_RAISE_DELAY_FRAMES)
+{
+}
+
+float ResolutionScaler::update(float frameTime, float budget) {
+    float sample = frameTime < budget * MAX_SAMPLE_RATIO ? frameTime : budget * MAX_SAMPLE_RATIO;
+    averageFrameTime += (sample - averageFrameTime) * SMOOTHING;
+    if (framesSinceRaise < MAX_RAISE_DELAY_FRAMES) {
+        framesSinceRaise++;
+    }
+
+    if (averageFrameTime > budget * OVER_BUDGET_RATIO) {
+        if (scale > MIN_SCALE) {
+            scale = scale - SCALE_STEP > MIN_SCALE ? scale - SCALE_STEP : MIN_SCALE;
+            if (framesSinceRaise < raiseDelay) {
+                raiseDelay = raiseDelay * 2 < MAX_RAISE_DELAY_FRAMES ? raiseDelay * 2 : MAX_RAISE_DELAY_FRAMES;
+            }
+            // The new scale gets a fresh average rather than paying for the old one
+            averageFrameTime = budget;
+        }
+        steadyFrames = 0;
+    }
+    else if (scale < MAX_SCALE && ++steadyFrames >= raiseDelay) {
+        scale = scale + SCALE_STEP < MAX_SCALE ? scale + SCALE_STEP : MAX_SCALE;
+        steadyFrames = 0;
+        framesSinceRaise = 0;
+    }
+    return scale;
+}
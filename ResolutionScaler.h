@@ -0,0 +1,23 @@
+#pragma once
+
+// Picks the fraction of the window's resolution the scene is rendered at,
+// from recent frame times. Frames are capped to the budget, so headroom can
+// not be measured directly: a run of on-budget frames is taken as a sign
+// that one step more will fit. A drop shortly after a raise doubles the wait
+// before the next try, so the scale settles instead of bouncing.
+class ResolutionScaler {
+private:
+    float scale;
+    float averageFrameTime;
+    int steadyFrames;
+    int raiseDelay;
+    int framesSinceRaise;
+
+public:
+    ResolutionScaler();
+
+    // frameTime is how long the last frame took and budget how long it was
+    // allowed to. Returns the scale for the next frame.
+    float update(float frameTime, float budget);
+    float getScale() const { return scale; }
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity FIFO. Storage is allocated once in the constructor; pushing
+// onto a full buffer overwrites the oldest entry instead of growing.
+template <typename T>
+class RingBuffer {
+private:
+    std::vector<T> items;
+    size_t head;
+    size_t count;
+
+    size_t wrap(size_t index) const { return index >= items.size() ? index - items.size() : index; }
+
+public:
+    explicit RingBuffer(size_t maxItems);
+
+    // Returns false when the oldest entry had to be dropped to make room.
+    bool push(const T& value);
+    void popFront();
+    void clear();
+
+    T& front() { return items[head]; }
+    const T& front() const { return items[head]; }
+
+    // Index 0 is the oldest entry.
+    T& operator[](size_t index) { return items[wrap(head + index)]; }
+    const T& operator[](size_t index) const { return items[wrap(head + index)]; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return items.size(); }
+    bool isFull() const { return count == items.size(); }
+    bool isEmpty() const { return count == 0; }
+};
+
+template <typename T>
+RingBuffer<T>::RingBuffer(size_t maxItems) :
+    items(maxItems),
+    head(0),
+    count(0)
+{
+}
+
+template <typename T>
+bool RingBuffer<T>::push(const T& value) {
+    if (items.empty()) {
+        return false;
+    }
+    bool dropped = false;
+    if (isFull()) {
+        popFront();
+        dropped = true;
+    }
+    items[wrap(head + count)] = value;
+    count++;
+    return !dropped;
+}
+
+template <typename T>
+void RingBuffer<T>::popFront() {
+    head = wrap(head + 1);
+    count--;
+}
+
+template <typename T>
+void RingBuffer<T>::clear() {
+    head = 0;
+    count = 0;
+}
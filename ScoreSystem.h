@@ -1,71 +1,110 @@
 #pragma once
 #include "raylib.h"
+#include "TextLayout.h"
+#include "RingBuffer.h"
+#include "Profiler.h"
 #include <vector>
-#include <string>
-#include <algorithm>
+#include <cstdio>
 
 class GameManager;
 
-class ScoreObserver {
-public:
-    virtual ~ScoreObserver() {}
-    virtual void onScoreUpdate(int score, int addedPoints, Vector2 position, Color color) = 0;
-};
+// Seconds a floating text stays up
+static const float FLOATING_TEXT_LIFETIME = 1.5f;
 
+// Every floating text lives for the same time, so they expire in the order
+// they were added. The label is kept inline so spawning one never allocates.
 struct FloatingText {
     Vector2 position;
-    std::string text;
+    float previousY;
+    char text[16];
     float alpha;
     float timer;
     int value;
     Color color;
 
+    FloatingText();
     FloatingText(Vector2 pos, int val, Color col);
     void update(float deltaTime);
-    void render(Font font) const;
+    void render(Font font, float interpolation) const;
     bool shouldRemove() const;
 };
 
+struct ScoreSnapshot;
+
 class ScoreSystem {
 private:
     int currentScore;
     int highScore;
-    std::vector<ScoreObserver*> observers;
-    std::vector<FloatingText> floatingTexts;
+    RingBuffer<FloatingText> floatingTexts;
+    unsigned long long droppedTexts;
     Font font;
 
+    mutable TextLayout scoreLayout;
+    mutable TextLayout highScoreLayout;
+    mutable int scoreLayoutValue;
+    mutable int highScoreLayoutValue;
+
 public:
+    static const size_t MAX_FLOATING_TEXTS = 64;
+
     ScoreSystem();
     ~ScoreSystem();
 
     void addScore(int points, Vector2 position, Color color);
     void resetScore();
     void update(float deltaTime);
-    void render() const;
+    void writeSnapshot(ScoreSnapshot& snapshot) const;
+    // Draws a snapshot rather than the live score, so it can run while the
+    // simulation thread carries on
+    void render(const ScoreSnapshot& snapshot, float alpha) const;
     void cleanupInactiveTexts();
 
-    void addObserver(ScoreObserver* observer);
-    void removeObserver(ScoreObserver* observer);
-    void notifyObservers(int score, int addedPoints, Vector2 position, Color color);
-
     int getScore() const { return currentScore; }
     int getHighScore() const { return highScore; }
+    void setHighScore(int score) { highScore = score; }
+    size_t getFloatingTextCount() const { return floatingTexts.size(); }
+    unsigned long long getDroppedTextCount() const { return droppedTexts; }
     void setFont(Font newFont) { font = newFont; }
 };
 
+// What the HUD shows at the end of a tick
+struct ScoreSnapshot {
+    int score;
+    int highScore;
+    FloatingText floatingTexts[ScoreSystem::MAX_FLOATING_TEXTS];
+    size_t floatingTextCount;
+
+    ScoreSnapshot() : score(0), highScore(0), floatingTexts(), floatingTextCount(0) {}
+};
+
 #include "GameManager.h"
+#include "Renderer.h"
+
+inline FloatingText::FloatingText() :
+    position{ 0, 0 },
+    previousY(0.0f),
+    text{},
+    alpha(0.0f),
+    timer(0.0f),
+    value(0),
+    color(BLANK)
+{
+}
 
 inline FloatingText::FloatingText(Vector2 pos, int val, Color col) :
     position(pos),
-    value(val),
-    color(col),
+    previousY(pos.y),
+    text{},
     alpha(1.0f),
-    timer(1.5f)
+    timer(FLOATING_TEXT_LIFETIME),
+    value(val),
+    color(col)
 {
-    text = "+" + std::to_string(value);
+    snprintf(text, sizeof(text), "+%d", value);
 }
 
 inline void FloatingText::update(float deltaTime) {
+    previousY = position.y;
     position.y -= 50.0f * deltaTime;
     timer -= deltaTime;
     if (timer <= 0.5f) {
@@ -73,10 +112,12 @@ inline void FloatingText::update(float deltaTime) {
     }
 }
 
-inline void FloatingText::render(Font font) const {
-    DrawTextEx(font, text.c_str(),
-        Vector2{ position.x - MeasureTextEx(font, text.c_str(), 20, 1).x / 2, position.y },
-        20, 1, ColorAlpha(color, alpha));
+inline void FloatingText::render(Font font, float interpolation) const {
+    GameManager* gm = GameManager::getInstance();
+    const TextLayout& layout = gm->getTextCache()->get(font, text, 20, 1);
+    gm->getRenderer()->drawTextLayout(font, layout,
+        Vector2{ position.x - layout.width / 2, previousY + (position.y - previousY) * interpolation },
+        ColorAlpha(color, alpha));
 }
 
 inline bool FloatingText::shouldRemove() const {
@@ -85,7 +126,14 @@ inline bool FloatingText::shouldRemove() const {
 
 inline ScoreSystem::ScoreSystem() :
     currentScore(0),
-    highScore(0)
+    highScore(0),
+    floatingTexts(MAX_FLOATING_TEXTS),
+    droppedTexts(0),
+    font(),
+    scoreLayout(),
+    highScoreLayout(),
+    scoreLayoutValue(-1),
+    highScoreLayoutValue(-1)
 {
     // GameManager will set the font
 }
@@ -100,8 +148,10 @@ inline void ScoreSystem::addScore(int points, Vector2 position, Color color) {
         highScore = currentScore;
     }
 
-    floatingTexts.push_back(FloatingText(position, points, color));
-    notifyObservers(currentScore, points, position, color);
+    // A burst of collects drops the oldest text, which is already fading out
+    if (!floatingTexts.push(FloatingText(position, points, color))) {
+        droppedTexts++;
+    }
 }
 
 inline void ScoreSystem::resetScore() {
@@ -110,48 +160,48 @@ inline void ScoreSystem::resetScore() {
 }
 
 inline void ScoreSystem::update(float deltaTime) {
-    for (auto& text : floatingTexts) {
-        text.update(deltaTime);
+    PROFILE_SCOPE("ScoreSystem::update");
+    for (size_t i = 0; i < floatingTexts.size(); i++) {
+        floatingTexts[i].update(deltaTime);
     }
     cleanupInactiveTexts();
 }
 
-inline void ScoreSystem::render() const {
-    GameManager* gm = GameManager::getInstance();
-    DrawTextEx(font, TextFormat("Score: %d", currentScore), Vector2{ 10, 10 }, 30, 1, WHITE);
+inline void ScoreSystem::writeSnapshot(ScoreSnapshot& snapshot) const {
+    snapshot.score = currentScore;
+    snapshot.highScore = highScore;
+    snapshot.floatingTextCount = floatingTexts.size();
+    for (size_t i = 0; i < floatingTexts.size(); i++) {
+        snapshot.floatingTexts[i] = floatingTexts[i];
+    }
+}
 
-    if (highScore > 0) {
-        DrawTextEx(font, TextFormat("High Score: %d", highScore), Vector2{ 10, 50 }, 20, 1, LIGHTGRAY);
+// The HUD strings are only formatted and laid out again when their value
+// changes; every other frame just replays the cached glyph quads.
+inline void ScoreSystem::render(const ScoreSnapshot& snapshot, float alpha) const {
+    PROFILE_SCOPE("ScoreSystem::render");
+    Renderer* renderer = GameManager::getInstance()->getRenderer();
+    if (scoreLayoutValue != snapshot.score) {
+        renderer->layoutText(font, TextFormat("Score: %d", snapshot.score), 30, 1, scoreLayout);
+        scoreLayoutValue = snapshot.score;
+    }
+    renderer->drawTextLayout(font, scoreLayout, Vector2{ 10, 10 }, WHITE);
+
+    if (snapshot.highScore > 0) {
+        if (highScoreLayoutValue != snapshot.highScore) {
+            renderer->layoutText(font, TextFormat("High Score: %d", snapshot.highScore), 20, 1, highScoreLayout);
+            highScoreLayoutValue = snapshot.highScore;
+        }
+        renderer->drawTextLayout(font, highScoreLayout, Vector2{ 10, 50 }, LIGHTGRAY);
     }
-    for (const auto& text : floatingTexts) {
-        text.render(font);
+    for (size_t i = 0; i < snapshot.floatingTextCount; i++) {
+        snapshot.floatingTexts[i].render(font, alpha);
     }
 }
 
+// Texts expire oldest first, so only the head ever needs checking.
 inline void ScoreSystem::cleanupInactiveTexts() {
-    floatingTexts.erase(
-        std::remove_if(
-            floatingTexts.begin(),
-            floatingTexts.end(),
-            [](const FloatingText& text) { return text.shouldRemove(); }
-        ),
-        floatingTexts.end()
-    );
-}
-
-inline void ScoreSystem::addObserver(ScoreObserver* observer) {
-    observers.push_back(observer);
-}
-
-inline void ScoreSystem::removeObserver(ScoreObserver* observer) {
-    observers.erase(
-        std::remove(observers.begin(), observers.end(), observer),
-        observers.end()
-    );
-}
-
-inline void ScoreSystem::notifyObservers(int score, int addedPoints, Vector2 position, Color color) {
-    for (auto observer : observers) {
-        observer->onScoreUpdate(score, addedPoints, position, color);
+    while (!floatingTexts.isEmpty() && floatingTexts.front().shouldRemove()) {
+        floatingTexts.popFront();
     }
-}
\ No newline at end of file
+}
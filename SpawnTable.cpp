@@ -0,0 +1,252 @@
+#include "SpawnTable.h"
+#include "ObjectFactory.h"
+#include "Random.h"
+#include <cstdio>
+#include <cstring>
+
+const char* SpawnTable::DEFAULT_PATH = "Resources/spawn.cfg";
+
+static const float POLL_INTERVAL = 0.5f;
+static const int MAX_TOTAL_WEIGHT = 1000000;
+
+static const char* TYPE_NAMES[] = { "DIAMOND", "RUBY", "AMETHYST", "GOLDBAR", "SILVERBAR", "DYNAMITE" };
+
+SpawnTable::SpawnTable() :
+    entries(),
+    minInterval(0.25f),
+    maxInterval(1.0f),
+    burst(1),
+    threshold(),
+    alias(),
+    totalWeight(0),
+    maxSize(0.0f),
+    path(),
+    modTime(0),
+    pollTimer(0.0f)
+{
+    static_assert(TYPE_COUNT == static_cast<int>(ObjectType::COUNT), "SpawnTable must cover every ObjectType");
+    static_assert(sizeof(TYPE_NAMES) / sizeof(TYPE_NAMES[0]) == TYPE_COUNT, "TYPE_NAMES must list every ObjectType");
+    setDefaults();
+    build();
+}
+
+// The original hardcoded table, used until a file loads.
+void SpawnTable::setDefaults() {
+    entries[static_cast<int>(ObjectType::DIAMOND)] = SpawnEntry{ 5, 15, SKYBLUE, 1.5f, 3.5f, 50.0f };
+    entries[static_cast<int>(ObjectType::RUBY)] = SpawnEntry{ 8, 12, RED, 1.5f, 3.5f, 50.0f };
+    entries[static_cast<int>(ObjectType::AMETHYST)] = SpawnEntry{ 12, 10, PURPLE, 1.5f, 3.5f, 50.0f };
+    entries[static_cast<int>(ObjectType::GOLDBAR)] = SpawnEntry{ 25, 8, GOLD, 1.5f, 3.5f, 50.0f };
+    entries[static_cast<int>(ObjectType::SILVERBAR)] = SpawnEntry{ 30, 5, LIGHTGRAY, 1.5f, 3.5f, 50.0f };
+    entries[static_cast<int>(ObjectType::DYNAMITE)] = SpawnEntry{ 20, 0, WHITE, 1.5f, 3.5f, 50.0f };
+    minInterval = 0.25f;
+    maxInterval = 1.0f;
+    burst = 1;
+}
+
+// Vose's alias method in integers. Each column holds totalWeight units and
+// type i brings weight * TYPE_COUNT of them, so the sampled distribution
+// matches the weights exactly.
+void SpawnTable::build() {
+    totalWeight = 0;
+    maxSize = 0.0f;
+    for (const SpawnEntry& entry : entries) {
+        totalWeight += entry.weight;
+        maxSize = entry.size > maxSize ? entry.size : maxSize;
+    }
+
+    uint32_t mass[TYPE_COUNT];
+    int small[TYPE_COUNT];
+    int large[TYPE_COUNT];
+    int smallCount = 0;
+    int largeCount = 0;
+    for (int i = 0; i < TYPE_COUNT; i++) {
+        mass[i] = (uint32_t)entries[i].weight * TYPE_COUNT;
+        alias[i] = (uint8_t)i;
+        if (mass[i] < totalWeight) {
+            small[smallCount++] = i;
+        }
+        else {
+            large[largeCount++] = i;
+        }
+    }
+    while (smallCount > 0 && largeCount > 0) {
+        int lower = small[--smallCount];
+        int upper = large[--largeCount];
+        threshold[lower] = mass[lower];
+        alias[lower] = (uint8_t)upper;
+        mass[upper] -= totalWeight - mass[lower];
+        if (mass[upper] < totalWeight) {
+            small[smallCount++] = upper;
+        }
+        else {
+            large[largeCount++] = upper;
+        }
+    }
+    while (largeCount > 0) {
+        threshold[large[--largeCount]] = totalWeight;
+    }
+    while (smallCount > 0) {
+        threshold[small[--smallCount]] = totalWeight;
+    }
+}
+
+// Format, one setting per line, '#' starts a comment:
+//   interval <min seconds> <max seconds>
+//   burst <objects per spawn>
+//   <TYPE> <weight> <score> <RRGGBB> <min speed> <max speed> <size>
+// Types left out of the file never spawn.
+bool SpawnTable::parse(const char* fileName) {
+    FILE* file = fopen(fileName, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "spawn table: cannot read %s\n", fileName);
+        return false;
+    }
+
+    SpawnEntry parsed[TYPE_COUNT] = {};
+    for (int i = 0; i < TYPE_COUNT; i++) {
+        parsed[i] = entries[i];
+        parsed[i].weight = 0;
+    }
+    float parsedMin = minInterval;
+    float parsedMax = maxInterval;
+    int parsedBurst = burst;
+
+    char line[256];
+    int lineNumber = 0;
+    const char* error = nullptr;
+    while (error == nullptr && fgets(line, sizeof(line), file) != nullptr) {
+        lineNumber++;
+        char* comment = strchr(line, '#');
+        if (comment != nullptr) {
+            *comment = '\0';
+        }
+        char key[32];
+        if (sscanf(line, "%31s", key) != 1) {
+            continue;
+        }
+
+        if (strcmp(key, "interval") == 0) {
+            if (sscanf(line, "%*s %f %f", &parsedMin, &parsedMax) != 2 ||
+                parsedMin <= 0.0f || parsedMax < parsedMin) {
+                error = "interval needs 0 < min <= max";
+            }
+            continue;
+        }
+        if (strcmp(key, "burst") == 0) {
+            if (sscanf(line, "%*s %d", &parsedBurst) != 1 || parsedBurst < 1 || parsedBurst > MAX_BURST) {
+                error = "burst must be between 1 and 64";
+            }
+            continue;
+        }
+
+        int type = -1;
+        for (int i = 0; i < TYPE_COUNT; i++) {
+            if (strcmp(key, TYPE_NAMES[i]) == 0) {
+                type = i;
+            }
+        }
+        if (type < 0) {
+            error = "unknown setting or object type";
+            continue;
+        }
+        SpawnEntry entry;
+        unsigned int rgb = 0;
+        if (sscanf(line, "%*s %d %d %x %f %f %f", &entry.weight, &entry.score, &rgb,
+                &entry.minSpeed, &entry.maxSpeed, &entry.size) != 6) {
+            error = "expected <weight> <score> <RRGGBB> <min speed> <max speed> <size>";
+        }
+        else if (entry.weight < 0 || entry.minSpeed < 0.0f || entry.maxSpeed < entry.minSpeed || entry.size <= 0.0f) {
+            error = "weight must be >= 0, speeds 0 <= min <= max and size > 0";
+        }
+        else {
+            entry.color = Color{ (unsigned char)(rgb >> 16), (unsigned char)(rgb >> 8), (unsigned char)rgb, 255 };
+            parsed[type] = entry;
+        }
+    }
+    fclose(file);
+
+    long long total = 0;
+    for (const SpawnEntry& entry : parsed) {
+        total += entry.weight;
+    }
+    if (error == nullptr && (total <= 0 || total > MAX_TOTAL_WEIGHT)) {
+        lineNumber = 0;
+        error = "weights must add up to between 1 and 1000000";
+    }
+    if (error != nullptr) {
+        fprintf(stderr, "spawn table: %s:%d: %s\n", fileName, lineNumber, error);
+        return false;
+    }
+
+    for (int i = 0; i < TYPE_COUNT; i++) {
+        entries[i] = parsed[i];
+    }
+    minInterval = parsedMin;
+    maxInterval = parsedMax;
+    burst = parsedBurst;
+    build();
+    return true;
+}
+
+bool SpawnTable::load(const char* fileName) {
+    path = fileName;
+    modTime = GetFileModTime(fileName);
+    pollTimer = 0.0f;
+    return parse(fileName);
+}
+
+bool SpawnTable::pollForChanges(float elapsed) {
+    if (path.empty()) {
+        return false;
+    }
+    pollTimer += elapsed;
+    if (pollTimer < POLL_INTERVAL) {
+        return false;
+    }
+    pollTimer = 0.0f;
+
+    long currentModTime = GetFileModTime(path.c_str());
+    if (currentModTime == modTime) {
+        return false;
+    }
+    modTime = currentModTime;
+    if (!parse(path.c_str())) {
+        return false;
+    }
+    TraceLog(LOG_INFO, "SPAWN: reloaded %s", path.c_str());
+    return true;
+}
+
+ObjectType SpawnTable::sample(uint32_t randomValue) const {
+    uint32_t draw = Random::bounded(randomValue, totalWeight * TYPE_COUNT);
+    uint32_t column = draw / totalWeight;
+    uint32_t offset = draw % totalWeight;
+    return static_cast<ObjectType>(offset < threshold[column] ? column : alias[column]);
+}
+
+float SpawnTable::drawInterval(uint32_t randomValue) const {
+    int minHundredths = (int)(minInterval * 100.0f + 0.5f);
+    int maxHundredths = (int)(maxInterval * 100.0f + 0.5f);
+    return (minHundredths + (int)Random::bounded(randomValue, (uint32_t)(maxHundredths - minHundredths) + 1)) / 100.0f;
+}
+
+uint32_t SpawnTable::getHash() const {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+    };
+    for (const SpawnEntry& entry : entries) {
+        mix(&entry.weight, sizeof(entry.weight));
+        mix(&entry.score, sizeof(entry.score));
+        mix(&entry.minSpeed, sizeof(entry.minSpeed));
+        mix(&entry.maxSpeed, sizeof(entry.maxSpeed));
+        mix(&entry.size, sizeof(entry.size));
+    }
+    mix(&minInterval, sizeof(minInterval));
+    mix(&maxInterval, sizeof(maxInterval));
+    mix(&burst, sizeof(burst));
+    return hash;
+}
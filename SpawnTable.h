@@ -0,0 +1,64 @@
+#pragma once
+#include "raylib.h"
+#include <cstdint>
+#include <string>
+
+enum class ObjectType;
+
+struct SpawnEntry {
+    int weight;
+    int score;
+    Color color;
+    float minSpeed;
+    float maxSpeed;
+    float size;
+};
+
+// What falls, how often and how fast, read from a text file (see
+// Resources/spawn.cfg for the format). Sampling uses an alias table, so
+// picking a type is one random draw and a lookup however the weights are
+// spread. A file that fails to parse leaves the current table in place.
+class SpawnTable {
+private:
+    static const int TYPE_COUNT = 6;
+
+    SpawnEntry entries[TYPE_COUNT];
+    float minInterval;
+    float maxInterval;
+    int burst;
+
+    // Column i keeps type i for draws below threshold[i], else gives alias[i]
+    uint32_t threshold[TYPE_COUNT];
+    uint8_t alias[TYPE_COUNT];
+    uint32_t totalWeight;
+    float maxSize;
+
+    std::string path;
+    long modTime;
+    float pollTimer;
+
+    void setDefaults();
+    void build();
+    bool parse(const char* fileName);
+
+public:
+    static const char* DEFAULT_PATH;
+    static const int MAX_BURST = 64;
+
+    SpawnTable();
+
+    bool load(const char* fileName);
+    // Reloads the file when its modification time changes. Checks at most
+    // twice a second.
+    bool pollForChanges(float elapsed);
+
+    // Both map one raw Random output, so callers can draw them in batches
+    ObjectType sample(uint32_t randomValue) const;
+    const SpawnEntry& getEntry(ObjectType type) const { return entries[static_cast<int>(type)]; }
+    float drawInterval(uint32_t randomValue) const;
+    int getBurst() const { return burst; }
+    float getMaxSize() const { return maxSize; }
+    // Covers everything that affects the simulation, so a replay can tell
+    // whether it is being played back against the table it was recorded with
+    uint32_t getHash() const;
+};
@@ -0,0 +1,31 @@
+#include "SpriteBatch.h"
+#include "Renderer.h"
+
+SpriteBatch::SpriteBatch(Renderer* batchRenderer, const TextureAtlas* spriteAtlas, size_t maxSprites) :
+    renderer(batchRenderer),
+    atlas(spriteAtlas),
+    capacity(maxSprites)
+{
+    commands.reserve(maxSprites);
+}
+
+void SpriteBatch::draw(SpriteId id, Rectangle dest, Vector2 origin, float rotation, Color tint) {
+    if (commands.size() == capacity) {
+        flush();
+    }
+    commands.push_back(SpriteCommand{ id, dest, origin, rotation, tint });
+}
+
+void SpriteBatch::draw(SpriteId id, float posX, float posY, Color tint) {
+    Rectangle source = atlas->getRect(id);
+    draw(id, Rectangle{ posX, posY, source.width, source.height }, Vector2{ 0, 0 }, 0.0f, tint);
+}
+
+void SpriteBatch::flush() {
+    Texture2D texture = atlas->getTexture();
+    for (const SpriteCommand& command : commands) {
+        renderer->drawTexturePro(texture, atlas->getRect(command.id),
+            command.dest, command.origin, command.rotation, command.tint);
+    }
+    commands.clear();
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "raylib.h"
+#include "TextureAtlas.h"
+#include <cstddef>
+#include <vector>
+
+class Renderer;
+
+struct SpriteCommand {
+    SpriteId id;
+    Rectangle dest;
+    Vector2 origin;
+    float rotation;
+    Color tint;
+};
+
+// Collects atlas sprites and submits them back to back on flush(), so text
+// or shapes drawn by the caller never split the batch in the middle of a
+// layer. The queue is sized up front and flushes itself if it fills.
+class SpriteBatch {
+private:
+    Renderer* renderer;
+    const TextureAtlas* atlas;
+    std::vector<SpriteCommand> commands;
+    size_t capacity;
+
+public:
+    SpriteBatch(Renderer* batchRenderer, const TextureAtlas* spriteAtlas, size_t maxSprites);
+
+    void draw(SpriteId id, Rectangle dest, Vector2 origin, float rotation, Color tint);
+    void draw(SpriteId id, float posX, float posY, Color tint);
+    void flush();
+
+    size_t pending() const { return commands.size(); }
+};
@@ -0,0 +1,41 @@
+#include "TextLayout.h"
+#include "Renderer.h"
+#include <functional>
+
+size_t TextLayoutCache::KeyHash::operator()(const Key& key) const {
+    size_t hash = std::hash<std::string>()(key.text);
+    hash ^= std::hash<unsigned int>()(key.fontId) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<float>()(key.fontSize) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+TextLayoutCache::TextLayoutCache(Renderer* layoutRenderer, size_t maxCachedLayouts) :
+    renderer(layoutRenderer),
+    maxEntries(maxCachedLayouts),
+    hits(0),
+    misses(0)
+{
+    layouts.reserve(maxCachedLayouts);
+}
+
+// The lookup key is a member so its string buffer is reused between calls.
+const TextLayout& TextLayoutCache::get(Font font, const char* text, float fontSize, float spacing) {
+    lookupKey.text.assign(text);
+    lookupKey.fontId = font.texture.id;
+    lookupKey.fontSize = fontSize;
+    lookupKey.spacing = spacing;
+
+    auto it = layouts.find(lookupKey);
+    if (it != layouts.end()) {
+        hits++;
+        return it->second;
+    }
+
+    misses++;
+    if (layouts.size() >= maxEntries) {
+        layouts.clear();
+    }
+    TextLayout& layout = layouts[lookupKey];
+    renderer->layoutText(font, text, fontSize, spacing, layout);
+    return layout;
+}
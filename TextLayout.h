@@ -0,0 +1,60 @@
+#pragma once
+#include "raylib.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Renderer;
+
+// Source rect in the font atlas and destination rect relative to the text
+// origin, ready to be drawn as-is.
+struct GlyphQuad {
+    Rectangle source;
+    Rectangle dest;
+};
+
+struct TextLayout {
+    float width;
+    float height;
+    std::vector<GlyphQuad> quads;
+};
+
+// Measured text and glyph quads keyed by (string, font, size). Strings that
+// repeat frame after frame are laid out once; the cache is dropped wholesale
+// when it grows past its limit, which only happens with ever-changing text.
+class TextLayoutCache {
+private:
+    struct Key {
+        std::string text;
+        unsigned int fontId;
+        float fontSize;
+        float spacing;
+
+        bool operator==(const Key& other) const {
+            return fontId == other.fontId && fontSize == other.fontSize &&
+                spacing == other.spacing && text == other.text;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    Renderer* renderer;
+    std::unordered_map<Key, TextLayout, KeyHash> layouts;
+    size_t maxEntries;
+    Key lookupKey;
+    unsigned long long hits;
+    unsigned long long misses;
+
+public:
+    TextLayoutCache(Renderer* layoutRenderer, size_t maxCachedLayouts);
+
+    const TextLayout& get(Font font, const char* text, float fontSize, float spacing);
+    void clear() { layouts.clear(); }
+
+    size_t size() const { return layouts.size(); }
+    unsigned long long getHits() const { return hits; }
+    unsigned long long getMisses() const { return misses; }
+};
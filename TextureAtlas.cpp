@@ -0,0 +1,71 @@
+#include "TextureAtlas.h"
+#include "Renderer.h"
+#include "AssetIds.h"
+#include <algorithm>
+
+static const int ATLAS_WIDTH = 1024;
+static const int SPRITE_PADDING = 2;
+
+static_assert(SPRITE_ASSET_COUNT == static_cast<int>(SpriteId::COUNT),
+    "sprite assets must line up with SpriteId");
+
+TextureAtlas::TextureAtlas() :
+    texture(Texture2D{})
+{
+    for (int i = 0; i < static_cast<int>(SpriteId::COUNT); i++) {
+        rects[i] = Rectangle{ 0, 0, 0, 0 };
+    }
+}
+
+// Shelf packing: sprites are placed tallest first, left to right, starting a
+// new shelf when the current one is full. Good enough for a dozen sprites.
+bool TextureAtlas::build(Renderer* renderer, const Image images[]) {
+    const int count = static_cast<int>(SpriteId::COUNT);
+    int order[count];
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    std::sort(order, order + count, [&images](int a, int b) {
+        return images[a].height > images[b].height;
+    });
+
+    int x = 0;
+    int y = 0;
+    int shelfHeight = 0;
+    for (int i = 0; i < count; i++) {
+        const Image& image = images[order[i]];
+        if (x + image.width > ATLAS_WIDTH) {
+            x = 0;
+            y += shelfHeight + SPRITE_PADDING;
+            shelfHeight = 0;
+        }
+        rects[order[i]] = Rectangle{ (float)x, (float)y, (float)image.width, (float)image.height };
+        x += image.width + SPRITE_PADDING;
+        shelfHeight = std::max(shelfHeight, image.height);
+    }
+
+    int atlasHeight = 1;
+    while (atlasHeight < y + shelfHeight) {
+        atlasHeight *= 2;
+    }
+
+    Image atlas = renderer->genImage(ATLAS_WIDTH, atlasHeight);
+    for (int i = 0; i < count; i++) {
+        renderer->drawImage(&atlas, images[i], (int)rects[i].x, (int)rects[i].y);
+    }
+    texture = renderer->loadTextureFromImage(atlas);
+    renderer->unloadImage(atlas);
+
+    return texture.id != 0;
+}
+
+AssetId TextureAtlas::getAsset(SpriteId id) {
+    return static_cast<AssetId>(id);
+}
+
+void TextureAtlas::unload(Renderer* renderer) {
+    if (texture.id != 0) {
+        renderer->unloadTexture(texture);
+        texture = Texture2D{};
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "raylib.h"
+
+class Renderer;
+enum class AssetId;
+
+enum class SpriteId {
+    BACKGROUND,
+    RAIL_LEFT,
+    RAIL_MID,
+    RAIL_RIGHT,
+    CART,
+    DIAMOND,
+    RUBY,
+    AMETHYST,
+    GOLDBAR,
+    SILVERBAR,
+    DYNAMITE,
+    COUNT
+};
+
+// All game sprites packed into one texture at load time, so everything drawn
+// from it can share a single raylib batch.
+class TextureAtlas {
+private:
+    Texture2D texture;
+    Rectangle rects[static_cast<int>(SpriteId::COUNT)];
+
+public:
+    TextureAtlas();
+
+    // Packs the decoded sprite images (indexed by SpriteId) and uploads the
+    // result. The images still belong to the caller.
+    bool build(Renderer* renderer, const Image images[]);
+    void unload(Renderer* renderer);
+
+    Texture2D getTexture() const { return texture; }
+    Rectangle getRect(SpriteId id) const { return rects[static_cast<int>(id)]; }
+    int getWidth(SpriteId id) const { return (int)rects[static_cast<int>(id)].width; }
+    int getHeight(SpriteId id) const { return (int)rects[static_cast<int>(id)].height; }
+
+    static AssetId getAsset(SpriteId id);
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Single-writer, single-reader handoff of whole values without locks. The
+// writer fills the back buffer and publishes it by swapping it with the
+// middle one; the reader swaps the middle one for its front buffer whenever
+// something new has been published. Neither side ever waits, and the reader
+// always gets the newest complete value.
+template <typename T>
+class TripleBuffer {
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t FRESH = 0x4;
+
+    T buffers[3];
+    std::atomic<uint8_t> middle;
+    uint8_t back;
+    uint8_t front;
+
+public:
+    // Each buffer is constructed from args in place, so capacity reserved by
+    // T's constructor survives
+    template <typename... Args>
+    explicit TripleBuffer(const Args&... args);
+
+    // Writer side
+    T& getBack() { return buffers[back]; }
+    void publish();
+
+    // Reader side. Returns the newest published value, or the same one as
+    // last time when nothing new has been published since.
+    const T& acquire();
+};
+
+template <typename T>
+template <typename... Args>
+TripleBuffer<T>::TripleBuffer(const Args&... args) :
+    buffers{ T(args...), T(args...), T(args...) },
+    middle(1),
+    back(0),
+    front(2)
+{
+}
+
+template <typename T>
+void TripleBuffer<T>::publish() {
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+template <typename T>
+const T& TripleBuffer<T>::acquire() {
+    if (middle.load(std::memory_order_relaxed) & FRESH) {
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+    return buffers[front];
+}
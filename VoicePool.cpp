@@ -0,0 +1,137 @@
+#include "VoicePool.h"
+#include "AudioDevice.h"
+
+VoicePool::VoicePool(AudioDevice* audioDevice, int maxVoices) :
+    audio(audioDevice),
+    voices(),
+    effects(),
+    maxActiveVoices(maxVoices),
+    nextStartOrder(1),
+    frameStats(),
+    lastFrameStats(),
+    totalPlayed(0),
+    totalDropped(0)
+{
+}
+
+VoicePool::~VoicePool() {
+    unload();
+}
+
+void VoicePool::addEffect(SoundEffect effect, Sound source, SoundEffectConfig config) {
+    Effect& slot = effects[static_cast<int>(effect)];
+    slot.config = config;
+    slot.firstVoice = (int)voices.size();
+    slot.voiceCount = 0;
+    slot.triggersThisFrame = 0;
+    for (int i = 0; i < config.maxVoices; i++) {
+        voices.push_back(Voice{ audio->loadSoundAlias(source), effect, 0 });
+        slot.voiceCount++;
+    }
+}
+
+// Aliases must go before the sounds they were made from.
+void VoicePool::unload() {
+    for (const Voice& voice : voices) {
+        audio->stopSound(voice.alias);
+        audio->unloadSoundAlias(voice.alias);
+    }
+    voices.clear();
+    for (Effect& effect : effects) {
+        effect.voiceCount = 0;
+    }
+}
+
+int VoicePool::countActiveVoices() const {
+    int active = 0;
+    for (const Voice& voice : voices) {
+        if (audio->isSoundPlaying(voice.alias)) {
+            active++;
+        }
+    }
+    return active;
+}
+
+// The oldest playing voice of the lowest-priority effect below priority, or -1.
+int VoicePool::findVictim(int priority) const {
+    int victim = -1;
+    for (int i = 0; i < (int)voices.size(); i++) {
+        const Voice& voice = voices[i];
+        int voicePriority = effects[static_cast<int>(voice.effect)].config.priority;
+        if (voicePriority >= priority || !audio->isSoundPlaying(voice.alias)) {
+            continue;
+        }
+        if (victim < 0) {
+            victim = i;
+            continue;
+        }
+        int victimPriority = effects[static_cast<int>(voices[victim].effect)].config.priority;
+        if (voicePriority < victimPriority ||
+            (voicePriority == victimPriority && voice.startOrder < voices[victim].startOrder)) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+// A free copy of the effect is used first. With every copy busy the oldest one
+// restarts. A new voice beyond the pool's budget has to take one from a
+// lower-priority effect, or the trigger is dropped.
+bool VoicePool::play(SoundEffect effect) {
+    Effect& slot = effects[static_cast<int>(effect)];
+    frameStats.triggers++;
+    if (slot.triggersThisFrame >= slot.config.maxTriggersPerFrame) {
+        frameStats.droppedRateLimit++;
+        totalDropped++;
+        return false;
+    }
+    slot.triggersThisFrame++;
+    if (slot.voiceCount == 0) {
+        frameStats.droppedNoVoice++;
+        totalDropped++;
+        return false;
+    }
+
+    int chosen = -1;
+    int oldest = -1;
+    for (int i = slot.firstVoice; i < slot.firstVoice + slot.voiceCount; i++) {
+        if (!audio->isSoundPlaying(voices[i].alias)) {
+            chosen = i;
+            break;
+        }
+        if (oldest < 0 || voices[i].startOrder < voices[oldest].startOrder) {
+            oldest = i;
+        }
+    }
+
+    if (chosen < 0) {
+        chosen = oldest;
+        audio->stopSound(voices[chosen].alias);
+        frameStats.stolen++;
+    }
+    else if (countActiveVoices() >= maxActiveVoices) {
+        int victim = findVictim(slot.config.priority);
+        if (victim < 0) {
+            frameStats.droppedNoVoice++;
+            totalDropped++;
+            return false;
+        }
+        audio->stopSound(voices[victim].alias);
+        frameStats.stolen++;
+    }
+
+    audio->playSound(voices[chosen].alias);
+    voices[chosen].startOrder = nextStartOrder++;
+    frameStats.played++;
+    totalPlayed++;
+    return true;
+}
+
+void VoicePool::beginFrame() {
+    frameStats.activeVoices = countActiveVoices();
+    lastFrameStats = frameStats;
+    frameStats = VoiceStats();
+    for (Effect& effect : effects) {
+        effect.triggersThisFrame = 0;
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "raylib.h"
+#include <cstdint>
+#include <vector>
+
+class AudioDevice;
+
+enum class SoundEffect {
+    COLLECT,
+    EXPLOSION,
+    COUNT
+};
+
+struct SoundEffectConfig {
+    int maxVoices;            // copies of the effect that may overlap
+    int priority;             // a higher priority takes voices from lower ones
+    int maxTriggersPerFrame;  // later triggers in the same frame are dropped
+};
+
+struct VoiceStats {
+    int triggers;
+    int played;
+    int stolen;
+    int droppedRateLimit;
+    int droppedNoVoice;
+    int activeVoices;
+};
+
+// Plays sound effects through a fixed set of aliases, so rapid triggers
+// overlap instead of restarting one voice. Every alias is created at load
+// time and play() only scans the handful of voices, so the cost per frame is
+// bounded by the trigger limits however many events arrive.
+class VoicePool {
+private:
+    struct Voice {
+        Sound alias;
+        SoundEffect effect;
+        uint64_t startOrder;
+    };
+
+    struct Effect {
+        SoundEffectConfig config;
+        int firstVoice;
+        int voiceCount;
+        int triggersThisFrame;
+    };
+
+    AudioDevice* audio;
+    std::vector<Voice> voices;
+    Effect effects[static_cast<int>(SoundEffect::COUNT)];
+    int maxActiveVoices;
+    uint64_t nextStartOrder;
+
+    VoiceStats frameStats;
+    VoiceStats lastFrameStats;
+    unsigned long long totalPlayed;
+    unsigned long long totalDropped;
+
+    int countActiveVoices() const;
+    int findVictim(int priority) const;
+
+public:
+    VoicePool(AudioDevice* audioDevice, int maxVoices);
+    ~VoicePool();
+
+    void addEffect(SoundEffect effect, Sound source, SoundEffectConfig config);
+    void unload();
+
+    bool play(SoundEffect effect);
+    // Resets the per-frame trigger limits and publishes the last frame's stats
+    void beginFrame();
+
+    const VoiceStats& getLastFrameStats() const { return lastFrameStats; }
+    unsigned long long getTotalPlayed() const { return totalPlayed; }
+    unsigned long long getTotalDropped() const { return totalDropped; }
+    int getMaxActiveVoices() const { return maxActiveVoices; }
+};
@@ -0,0 +1,509 @@
+// Per-frame hot path benchmarks. Runs on the headless backend, so it needs no
+// window, GPU or audio device. Each result is printed as one JSON object per
+// line:
+//   {"bench":"...","objects":N,"ns_per_object":X,"allocs_per_frame":Y}
+// update, collision and broadphase add a "simd" field and tick-threads a "threads" field.
+// Run from the build directory so Resources/ resolves to the copied assets.
+#include "raylib.h"
+#include "GameManager.h"
+#include "GameStates.h"
+#include "ObjectFactory.h"
+#include "BroadPhase.h"
+#include "ScoreSystem.h"
+#include "Player.h"
+#include "MotionKernels.h"
+#include "Renderer.h"
+#include "RenderSnapshot.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+static std::atomic<long long> allocationCount(0);
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* memory = malloc(size ? size : 1);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+namespace {
+
+const float FRAME_TIME = 1.0f / 60.0f;
+const int OBJECT_COUNTS[] = { 10, 100, 1000, 10000, 100000 };
+// The score system never holds more floating texts than this
+const int TEXT_COUNTS[] = { 1, 10, 32, (int)ScoreSystem::MAX_FLOATING_TEXTS };
+const long long WORK_PER_SAMPLE = 2000000;
+
+struct Result {
+    double nanoseconds;
+    long long allocations;
+    long long frames;
+};
+
+class Stopwatch {
+private:
+    std::chrono::steady_clock::time_point start;
+    long long allocationsAtStart;
+
+public:
+    Stopwatch() :
+        start(std::chrono::steady_clock::now()),
+        allocationsAtStart(allocationCount.load())
+    {
+    }
+
+    void resume() {
+        start = std::chrono::steady_clock::now();
+        allocationsAtStart = allocationCount.load();
+    }
+
+    void pauseInto(Result& result) const {
+        result.nanoseconds += std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count();
+        result.allocations += allocationCount.load() - allocationsAtStart;
+    }
+};
+
+void report(const char* name, int objects, const Result& result) {
+    double perObject = result.nanoseconds / (double(result.frames) * objects);
+    double allocsPerFrame = double(result.allocations) / double(result.frames);
+    printf("{\"bench\":\"%s\",\"objects\":%d,\"frames\":%lld,\"ns_per_object\":%.3f,\"allocs_per_frame\":%.3f}\n",
+        name, objects, result.frames, perObject, allocsPerFrame);
+    fflush(stdout);
+}
+
+void reportThreads(const char* name, int objects, int threads, const Result& result) {
+    double perObject = result.nanoseconds / (double(result.frames) * objects);
+    double allocsPerFrame = double(result.allocations) / double(result.frames);
+    printf("{\"bench\":\"%s\",\"objects\":%d,\"threads\":%d,\"frames\":%lld,\"ns_per_object\":%.3f,\"allocs_per_frame\":%.3f}\n",
+        name, objects, threads, result.frames, perObject, allocsPerFrame);
+    fflush(stdout);
+}
+
+void reportSimd(const char* name, int objects, SimdLevel level, const Result& result) {
+    double perObject = result.nanoseconds / (double(result.frames) * objects);
+    double allocsPerFrame = double(result.allocations) / double(result.frames);
+    printf("{\"bench\":\"%s\",\"objects\":%d,\"simd\":\"%s\",\"frames\":%lld,\"ns_per_object\":%.3f,\"allocs_per_frame\":%.3f}\n",
+        name, objects, getSimdLevelName(level), result.frames, perObject, allocsPerFrame);
+    fflush(stdout);
+}
+
+long long framesFor(int objects) {
+    long long frames = WORK_PER_SAMPLE / objects;
+    return frames < 10 ? 10 : frames;
+}
+
+// Objects are spread over the upper part of the playfield, well clear of the
+// cart, so a few frames of falling never trigger a collision.
+void fillObjects(FallingObjectPool& pool, int count) {
+    GameManager* gm = GameManager::getInstance();
+    pool.clear();
+    for (int i = 0; i < count; i++) {
+        Vector2 position = {
+            20.0f + float(i % (gm->getScreenWidth() - 40)),
+            -50.0f + float((i * 7) % 300)
+        };
+        ObjectType type = static_cast<ObjectType>(i % static_cast<int>(ObjectType::DYNAMITE));
+        pool.acquire(position, 2.5f, ObjectFactory::getSprite(type), 50.0f, type, 5);
+    }
+}
+
+// Runs run(objects) once per SIMD level this CPU supports, then goes back to
+// the detected level.
+void forEachSimdLevel(int objects, void (*run)(int objects, SimdLevel level)) {
+    const SimdLevel levels[] = { SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2 };
+    for (SimdLevel level : levels) {
+        if (setSimdLevel(level)) {
+            run(objects, level);
+        }
+    }
+    setSimdLevel(detectSimdLevel());
+}
+
+void benchIntegrate(int objects, SimdLevel level) {
+    GameManager* gm = GameManager::getInstance();
+    FallingObjectPool& pool = gm->getObjectFactory()->getPool();
+    const MotionKernels& kernels = getMotionKernels();
+    float screenBottom = (float)gm->getScreenHeight();
+    Result result = { 0.0, 0, 0 };
+    long long frames = framesFor(objects);
+    while (result.frames < frames) {
+        fillObjects(pool, objects);
+        MotionArrays motion = pool.getMotion();
+        Stopwatch watch;
+        for (int frame = 0; frame < 10; frame++) {
+            kernels.integrate(motion, 0, pool.size(), FRAME_TIME, screenBottom);
+        }
+        watch.pauseInto(result);
+        result.frames += 10;
+    }
+    reportSimd("MotionKernels::integrate", objects, level, result);
+}
+
+void benchUpdate(int objects) {
+    forEachSimdLevel(objects, benchIntegrate);
+}
+
+// Objects cover the whole playfield here, including the rail row, so some
+// of them really do touch the cart.
+void fillPlayfield(FallingObjectPool& pool, int count) {
+    GameManager* gm = GameManager::getInstance();
+    pool.clear();
+    for (int i = 0; i < count; i++) {
+        Vector2 position = {
+            20.0f + float((i * 37) % (gm->getScreenWidth() - 40)),
+            float((i * 13) % gm->getScreenHeight())
+        };
+        pool.acquire(position, 2.5f, SpriteId::SILVERBAR, 50.0f, ObjectType::SILVERBAR, 5);
+    }
+}
+
+void benchCollide(int objects, SimdLevel level) {
+    GameManager* gm = GameManager::getInstance();
+    FallingObjectPool& pool = gm->getObjectFactory()->getPool();
+    Rectangle hitbox = gm->getPlayer()->getHitbox();
+    const MotionKernels& kernels = getMotionKernels();
+
+    fillPlayfield(pool, objects);
+    std::vector<uint32_t> hits(pool.size());
+    MotionArrays motion = pool.getMotion();
+
+    Result result = { 0.0, 0, 0 };
+    long long frames = framesFor(objects);
+    long long hitCount = 0;
+    Stopwatch watch;
+    for (long long frame = 0; frame < frames; frame++) {
+        hitCount += (long long)kernels.collide(motion, 0, pool.size(), hitbox, hits.data());
+    }
+    watch.pauseInto(result);
+    result.frames = frames;
+
+    printf("{\"bench\":\"MotionKernels::collide\",\"objects\":%d,\"simd\":\"%s\",\"frames\":%lld,\"ns_per_object\":%.3f,\"allocs_per_frame\":%.3f,\"hits_per_frame\":%.1f}\n",
+        objects, getSimdLevelName(level), result.frames, result.nanoseconds / (double(result.frames) * objects),
+        double(result.allocations) / double(result.frames), double(hitCount) / double(frames));
+    fflush(stdout);
+}
+
+void benchCollision(int objects) {
+    forEachSimdLevel(objects, benchCollide);
+}
+
+// The same objects as collision, through the cull kernel and the exact test
+// on what it keeps, so the two lines compare directly.
+void benchBroadPhaseLevel(int objects, SimdLevel level) {
+    GameManager* gm = GameManager::getInstance();
+    FallingObjectPool& pool = gm->getObjectFactory()->getPool();
+    BroadPhase* broadPhase = gm->getBroadPhase();
+    Rectangle hitbox = gm->getPlayer()->getHitbox();
+    const MotionKernels& kernels = getMotionKernels();
+
+    fillPlayfield(pool, objects);
+    std::vector<uint32_t> hits(pool.size());
+    MotionArrays motion = pool.getMotion();
+
+    Result result = { 0.0, 0, 0 };
+    long long frames = framesFor(objects);
+    long long hitCount = 0;
+    unsigned long long rejectedBefore = broadPhase->getStats().totalRejected;
+    Stopwatch watch;
+    for (long long frame = 0; frame < frames; frame++) {
+        size_t candidates = 0;
+        broadPhase->begin(hitbox, pool.getMaxSize());
+        hitCount += (long long)broadPhase->collide(kernels, motion, 0, pool.size(), hits.data(), candidates);
+        broadPhase->record(pool.size(), candidates);
+    }
+    watch.pauseInto(result);
+    result.frames = frames;
+
+    double rejected = double(broadPhase->getStats().totalRejected - rejectedBefore) / double(frames);
+    printf("{\"bench\":\"BroadPhase::collide\",\"objects\":%d,\"simd\":\"%s\",\"frames\":%lld,\"ns_per_object\":%.3f,\"allocs_per_frame\":%.3f,\"rejected_per_frame\":%.1f,\"hits_per_frame\":%.1f}\n",
+        objects, getSimdLevelName(level), result.frames, result.nanoseconds / (double(result.frames) * objects),
+        double(result.allocations) / double(result.frames), rejected, double(hitCount) / double(frames));
+    fflush(stdout);
+}
+
+void benchBroadPhase(int objects) {
+    forEachSimdLevel(objects, benchBroadPhaseLevel);
+}
+
+// Submission cost on the null renderer, plus the draw calls raylib would
+// issue for the same command stream.
+void benchRender(int objects) {
+    GameManager* gm = GameManager::getInstance();
+    Renderer* renderer = gm->getRenderer();
+    fillObjects(gm->getObjectFactory()->getPool(), objects);
+    GameplayState state(gm->getObjectFactory()->getPool().capacity());
+    gm->publishSnapshot(1.0f);
+    const RenderSnapshot& snapshot = gm->acquireSnapshot();
+
+    Result result = { 0.0, 0, 0 };
+    long long frames = framesFor(objects);
+    long long drawCalls = 0;
+    Stopwatch watch;
+    for (long long frame = 0; frame < frames; frame++) {
+        renderer->beginFrame(RAYWHITE);
+        state.render(snapshot);
+        renderer->endFrame();
+        drawCalls += renderer->getLastFrameStats().drawCalls;
+    }
+    watch.pauseInto(result);
+    result.frames = frames;
+
+    printf("{\"bench\":\"GameplayState::render\",\"objects\":%d,\"frames\":%lld,\"ns_per_object\":%.3f,\"allocs_per_frame\":%.3f,\"draw_calls_per_frame\":%.2f}\n",
+        objects, result.frames, result.nanoseconds / (double(result.frames) * objects),
+        double(result.allocations) / double(result.frames), double(drawCalls) / double(frames));
+    fflush(stdout);
+}
+
+void benchCleanup(int objects) {
+    FallingObjectPool& pool = GameManager::getInstance()->getObjectFactory()->getPool();
+    GameplayState state(pool.capacity());
+    Result result = { 0.0, 0, 0 };
+    long long frames = framesFor(objects);
+    while (result.frames < frames) {
+        fillObjects(pool, objects);
+        for (size_t i = 0; i < pool.size(); i += 2) {
+            pool.setActive(i, false);
+        }
+        Stopwatch watch;
+        state.cleanupInactiveObjects();
+        watch.pauseInto(result);
+        result.frames++;
+    }
+    report("GameplayState::cleanupInactiveObjects", objects, result);
+}
+
+void benchCreate(int objects) {
+    ObjectFactory* factory = GameManager::getInstance()->getObjectFactory();
+    Result result = { 0.0, 0, 0 };
+    long long frames = framesFor(objects);
+    while (result.frames < frames) {
+        factory->releaseAll();
+        Stopwatch watch;
+        for (int i = 0; i < objects; i++) {
+            factory->createObject();
+        }
+        watch.pauseInto(result);
+        result.frames++;
+    }
+    report("ObjectFactory::createObject", objects, result);
+}
+
+void benchCreateBatch(int objects) {
+    ObjectFactory* factory = GameManager::getInstance()->getObjectFactory();
+    ObjectHandle handles[ObjectFactory::SPAWN_BATCH];
+    Result result = { 0.0, 0, 0 };
+    long long frames = framesFor(objects);
+    while (result.frames < frames) {
+        factory->releaseAll();
+        Stopwatch watch;
+        for (int created = 0; created < objects; created += ObjectFactory::SPAWN_BATCH) {
+            size_t count = objects - created < (int)ObjectFactory::SPAWN_BATCH ? objects - created : ObjectFactory::SPAWN_BATCH;
+            factory->createObjects(count, handles);
+        }
+        watch.pauseInto(result);
+        result.frames++;
+    }
+    report("ObjectFactory::createObjects", objects, result);
+}
+
+// Ten frames is well inside a text's lifetime, so none expire while timed
+void benchScoreUpdate(int texts) {
+    ScoreSystem* scoreSystem = GameManager::getInstance()->getScoreSystem();
+    Result result = { 0.0, 0, 0 };
+    long long frames = framesFor(texts);
+    int live = 0;
+    while (result.frames < frames) {
+        scoreSystem->resetScore();
+        for (int i = 0; i < texts; i++) {
+            scoreSystem->addScore(5, Vector2{ float(i % 800), 300.0f }, GOLD);
+        }
+        live = (int)scoreSystem->getFloatingTextCount();
+        Stopwatch watch;
+        for (int frame = 0; frame < 10; frame++) {
+            scoreSystem->update(FRAME_TIME);
+        }
+        watch.pauseInto(result);
+        result.frames += 10;
+    }
+    report("ScoreSystem::update", live, result);
+}
+
+// Collecting a gem spawns a floating text; past MAX_FLOATING_TEXTS every
+// call also drops the oldest one.
+void benchScoreAdd(int objects) {
+    ScoreSystem* scoreSystem = GameManager::getInstance()->getScoreSystem();
+    Result result = { 0.0, 0, 0 };
+    long long frames = framesFor(objects);
+    while (result.frames < frames) {
+        scoreSystem->resetScore();
+        Stopwatch watch;
+        for (int i = 0; i < objects; i++) {
+            scoreSystem->addScore(5, Vector2{ float(i % 800), 300.0f }, GOLD);
+        }
+        watch.pauseInto(result);
+        result.frames++;
+    }
+    report("ScoreSystem::addScore", objects, result);
+}
+
+// Texts are aged to half a frame short of their lifetime, then the timed
+// update expires every one of them and its cleanup removes them all. The
+// time includes advancing the texts; score-update shows that part alone.
+void benchScoreCleanup(int texts) {
+    ScoreSystem* scoreSystem = GameManager::getInstance()->getScoreSystem();
+    Result result = { 0.0, 0, 0 };
+    long long frames = framesFor(texts);
+    int live = 0;
+    while (result.frames < frames) {
+        scoreSystem->resetScore();
+        for (int i = 0; i < texts; i++) {
+            scoreSystem->addScore(5, Vector2{ float(i % 800), 300.0f }, GOLD);
+        }
+        scoreSystem->update(FLOATING_TEXT_LIFETIME - FRAME_TIME / 2);
+        live = (int)scoreSystem->getFloatingTextCount();
+        Stopwatch watch;
+        scoreSystem->update(FRAME_TIME);
+        watch.pauseInto(result);
+        result.frames++;
+        if (scoreSystem->getFloatingTextCount() != 0) {
+            fprintf(stderr, "score-cleanup: %zu texts left unexpired\n", scoreSystem->getFloatingTextCount());
+        }
+    }
+    report("ScoreSystem::cleanupInactiveTexts", live, result);
+}
+
+void benchTick(int objects) {
+    GameManager* gm = GameManager::getInstance();
+    FallingObjectPool& pool = gm->getObjectFactory()->getPool();
+    GameplayState state(pool.capacity());
+    state.enter();
+
+    Result result = { 0.0, 0, 0 };
+    long long frames = framesFor(objects);
+    while (result.frames < frames) {
+        fillObjects(pool, objects);
+        Stopwatch watch;
+        for (int frame = 0; frame < 10; frame++) {
+            state.update(FRAME_TIME);
+        }
+        watch.pauseInto(result);
+        result.frames += 10;
+    }
+    report("GameplayState::update", objects, result);
+}
+
+// The same tick as benchTick with 1, 2, 4... threads up to the core count.
+// Smaller pools never take the parallel path, so they are skipped.
+void benchTickThreads(int objects) {
+    if (objects < (int)GameplayState::PARALLEL_THRESHOLD) {
+        return;
+    }
+    GameManager* gm = GameManager::getInstance();
+    FallingObjectPool& pool = gm->getObjectFactory()->getPool();
+    int maxThreads = (int)std::thread::hardware_concurrency();
+    maxThreads = maxThreads > 1 ? maxThreads : 2;
+
+    for (int step = 1; ; step *= 2) {
+        int threads = step < maxThreads ? step : maxThreads;
+        gm->setJobThreads(threads);
+        GameplayState state(pool.capacity());
+        state.enter();
+
+        Result result = { 0.0, 0, 0 };
+        long long frames = framesFor(objects);
+        while (result.frames < frames) {
+            fillObjects(pool, objects);
+            Stopwatch watch;
+            for (int frame = 0; frame < 10; frame++) {
+                state.update(FRAME_TIME);
+            }
+            watch.pauseInto(result);
+            result.frames += 10;
+        }
+        reportThreads("GameplayState::update", objects, threads, result);
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+    gm->setJobThreads(1);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const char* only = nullptr;
+    unsigned int seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+        }
+    }
+
+    GameManager* gm = GameManager::getInstance();
+    gm->setObjectCapacity(100000);
+    // Single-threaded unless a benchmark asks otherwise, so results compare
+    // across machines
+    gm->setJobThreads(1);
+    gm->initialize(true);
+    // A fixed seed keeps spawn-driven benchmarks comparable between runs
+    gm->setRandomSeed(seed);
+
+    struct Benchmark {
+        const char* name;
+        void (*run)(int objects);
+        // Swept over TEXT_COUNTS instead of OBJECT_COUNTS
+        bool floatingTexts;
+    };
+    const Benchmark benchmarks[] = {
+        { "update", benchUpdate, false },
+        { "collision", benchCollision, false },
+        { "broadphase", benchBroadPhase, false },
+        { "cleanup", benchCleanup, false },
+        { "create", benchCreate, false },
+        { "create-batch", benchCreateBatch, false },
+        { "score-add", benchScoreAdd, false },
+        { "score-update", benchScoreUpdate, true },
+        { "score-cleanup", benchScoreCleanup, true },
+        { "tick", benchTick, false },
+        { "tick-threads", benchTickThreads, false },
+        { "render", benchRender, false },
+    };
+
+    for (const Benchmark& benchmark : benchmarks) {
+        if (only != nullptr && strcmp(only, benchmark.name) != 0) {
+            continue;
+        }
+        if (benchmark.floatingTexts) {
+            for (int texts : TEXT_COUNTS) {
+                benchmark.run(texts);
+            }
+            continue;
+        }
+        for (int objects : OBJECT_COUNTS) {
+            benchmark.run(objects);
+        }
+    }
+
+    gm->cleanup();
+    return 0;
+}
@@ -1,31 +1,315 @@
 #include "raylib.h"
 #include "GameManager.h"
 #include "ScoreSystem.h"
+#include "GameEvents.h"
+#include "Platform.h"
+#include "Renderer.h"
+#include "Replay.h"
+#include "VoicePool.h"
+#include "BroadPhase.h"
+#include "MotionKernels.h"
+#include "Profiler.h"
+#include "FramePacer.h"
+#include "Leaderboard.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
-class SoundObserver : public ScoreObserver {
+// Triggers a sound per event; the voice pool's per-frame limits decide how
+// many of a burst are actually heard.
+class SoundListener {
 private:
-    GameManager* gameManager;
+    Subscription collectSubscription;
+    Subscription explosionSubscription;
 
 public:
-    SoundObserver(GameManager* gm) : gameManager(gm) {}
+    SoundListener(GameManager* gm) :
+        collectSubscription(gm->getEventBus()->subscribe<GemCollectedEvent>(
+            [gm](const EventBatch<GemCollectedEvent>& batch) {
+                for (size_t i = 0; i < batch.size(); i++) {
+                    gm->playCollectSound();
+                }
+            })),
+        explosionSubscription(gm->getEventBus()->subscribe<ExplosionEvent>(
+            [gm](const EventBatch<ExplosionEvent>& batch) {
+                for (size_t i = 0; i < batch.size(); i++) {
+                    gm->playExplosionSound();
+                }
+            }))
+    {
+    }
+};
+
+// Session totals for the headless summary.
+class SessionStats {
+private:
+    Subscription spawnSubscription;
+    Subscription collectSubscription;
+    Subscription explosionSubscription;
+
+public:
+    unsigned long long spawned;
+    unsigned long long collected;
+    unsigned long long explosions;
 
-    void onScoreUpdate(int score, int addedPoints, Vector2 position, Color color) override {
-        gameManager->playCollectSound();
+    SessionStats(EventBus* bus) :
+        spawnSubscription(bus->subscribe<SpawnEvent>(
+            [this](const EventBatch<SpawnEvent>& batch) { spawned += batch.size(); })),
+        collectSubscription(bus->subscribe<GemCollectedEvent>(
+            [this](const EventBatch<GemCollectedEvent>& batch) { collected += batch.size(); })),
+        explosionSubscription(bus->subscribe<ExplosionEvent>(
+            [this](const EventBatch<ExplosionEvent>& batch) { explosions += batch.size(); })),
+        spawned(0),
+        collected(0),
+        explosions(0)
+    {
     }
 };
 
-int main() {
+static const size_t GEM_STORM_CAPACITY = 50000;
+static const char* GEM_STORM_SPAWN_TABLE = "Resources/spawn_storm.cfg";
+
+struct LaunchOptions {
+    bool headless;
+    long long frames;
+    const char* recordPath;
+    const char* replayPath;
+    float replaySpeed;
+    int simulationRate;
+    const char* tracePath;
+    const char* spawnTablePath;
+    long long seed;
+    int threads;
+    bool gemStorm;
+    const char* simdLevel;
+    bool simulationThread;
+    float resolutionScale;
+    const char* pacing;
+    int fps;
+    bool lowLatency;
+    const char* leaderboardPath;
+};
+
+static LaunchOptions parseArguments(int argc, char** argv) {
+    LaunchOptions options = { false, -1, nullptr, nullptr, 1.0f, 60, nullptr, nullptr, -1, 0, false, nullptr, false, 0.0f, nullptr, 60, false, nullptr };
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            options.headless = true;
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options.frames = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            options.replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay-speed") == 0 && i + 1 < argc) {
+            options.replaySpeed = (float)atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--sim-hz") == 0 && i + 1 < argc) {
+            options.simulationRate = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            options.tracePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = strtoll(argv[++i], nullptr, 10) & 0xFFFFFFFFLL;
+        }
+        else if (strcmp(argv[i], "--spawn-table") == 0 && i + 1 < argc) {
+            options.spawnTablePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--simd") == 0 && i + 1 < argc) {
+            options.simdLevel = argv[++i];
+        }
+        else if (strcmp(argv[i], "--gem-storm") == 0) {
+            options.gemStorm = true;
+        }
+        else if (strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc) {
+            options.resolutionScale = (float)atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--sim-thread") == 0) {
+            options.simulationThread = true;
+        }
+        else if (strcmp(argv[i], "--pacing") == 0 && i + 1 < argc) {
+            options.pacing = argv[++i];
+        }
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            options.fps = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--low-latency") == 0) {
+            options.lowLatency = true;
+        }
+        else if (strcmp(argv[i], "--leaderboard") == 0 && i + 1 < argc) {
+            options.leaderboardPath = argv[++i];
+        }
+    }
+    return options;
+}
+
+static bool selectSimdLevel(const char* name) {
+    const SimdLevel levels[] = { SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2 };
+    for (SimdLevel level : levels) {
+        if (strcmp(name, getSimdLevelName(level)) == 0) {
+            return setSimdLevel(level);
+        }
+    }
+    return false;
+}
+
+static bool selectPacingPolicy(const char* name, PacingPolicy& policy) {
+    const char* names[] = { "cap", "vsync", "uncapped" };
+    const PacingPolicy policies[] = { PacingPolicy::CAP, PacingPolicy::VSYNC, PacingPolicy::UNCAPPED };
+    for (int i = 0; i < 3; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            policy = policies[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    LaunchOptions options = parseArguments(argc, argv);
+
+    if (options.simdLevel != nullptr && !selectSimdLevel(options.simdLevel)) {
+        fprintf(stderr, "--simd %s: not supported here, using %s\n",
+            options.simdLevel, getSimdLevelName(getMotionKernels().level));
+    }
+
+    PacingPolicy pacing = PacingPolicy::CAP;
+    if (options.pacing != nullptr && !selectPacingPolicy(options.pacing, pacing)) {
+        fprintf(stderr, "--pacing %s: expected cap, vsync or uncapped, using cap\n", options.pacing);
+    }
+
     GameManager* gameManager = GameManager::getInstance();
-    gameManager->initialize();
-    SoundObserver* soundObserver = new SoundObserver(gameManager);
-    gameManager->getScoreSystem()->addObserver(soundObserver);
-    while (!WindowShouldClose()) {
-        float deltaTime = GetFrameTime();
-        gameManager->update(deltaTime);
+    gameManager->setFramePacing(pacing, options.fps > 0 ? options.fps : 60, options.lowLatency);
+    if (options.simulationRate > 0) {
+        gameManager->setSimulationRate(options.simulationRate);
+    }
+    // Tens of thousands of gems on screen at once, to put the job system to work
+    if (options.gemStorm) {
+        gameManager->setObjectCapacity(GEM_STORM_CAPACITY);
+        if (options.spawnTablePath == nullptr) {
+            options.spawnTablePath = GEM_STORM_SPAWN_TABLE;
+        }
+    }
+    if (options.spawnTablePath != nullptr) {
+        gameManager->setSpawnTablePath(options.spawnTablePath);
+    }
+    gameManager->setJobThreads(options.threads);
+    // Headless frames are simulated time, not wall-clock time, so there is
+    // nothing to overlap
+    gameManager->setThreadedSimulation(options.simulationThread && !options.headless);
+    if (options.resolutionScale > 0.0f) {
+        gameManager->setResolutionScale(options.resolutionScale < 1.0f ? options.resolutionScale : 1.0f);
+    }
+    // Played back runs are not new runs, and headless ones only count when asked
+    if (options.replayPath == nullptr) {
+        if (options.leaderboardPath != nullptr) {
+            gameManager->setLeaderboardPath(options.leaderboardPath);
+        }
+        else if (!options.headless) {
+            gameManager->setLeaderboardPath(Leaderboard::DEFAULT_PATH);
+        }
+    }
+    gameManager->initialize(options.headless);
+    // A replay brings its own seed
+    if (options.seed >= 0) {
+        gameManager->setRandomSeed((unsigned int)options.seed);
+    }
+    Platform* platform = gameManager->getPlatform();
+
+    if (options.replayPath != nullptr) {
+        if (!gameManager->startPlayback(options.replayPath)) {
+            gameManager->cleanup();
+            return 1;
+        }
+        // Speed 0 drops the frame cap and runs one tick per frame, as fast as
+        // the machine allows
+        if (options.replaySpeed > 0.0f) {
+            gameManager->setTimeScale(options.replaySpeed);
+        }
+        else {
+            gameManager->setLockstep(true);
+            gameManager->setFramePacing(PacingPolicy::UNCAPPED, options.fps, options.lowLatency);
+        }
+    }
+    else if (options.recordPath != nullptr) {
+        if (!gameManager->startRecording(options.recordPath)) {
+            gameManager->cleanup();
+            return 1;
+        }
+    }
+
+    if (options.headless) {
+        // A replay runs until its input runs out unless --frames cuts it short
+        long long frames = options.frames;
+        if (frames < 0 && options.replayPath == nullptr) {
+            frames = 1000000;
+        }
+        static_cast<NullPlatform*>(platform)->setFrameLimit(frames);
+    }
+
+    SoundListener soundListener(gameManager);
+    SessionStats stats(gameManager->getEventBus());
+
+    auto start = std::chrono::steady_clock::now();
+    long long frames = 0;
+    long long drawCalls = 0;
+    while (!platform->shouldClose() && !gameManager->isReplayFinished()) {
+        gameManager->waitForFrame();
+        float deltaTime = platform->getFrameTime();
+        gameManager->advance(deltaTime);
         gameManager->render();
+        drawCalls += gameManager->getRenderer()->getLastFrameStats().drawCalls;
+        frames++;
+        PROFILE_FRAME_END();
+    }
+    gameManager->stopSimulationThread();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (options.headless) {
+        printf("headless: %lld frames in %.3f s (%.0f frames/s), %.2f draw calls/frame, high score %d\n",
+            frames, seconds, seconds > 0.0 ? frames / seconds : 0.0,
+            frames > 0 ? double(drawCalls) / frames : 0.0,
+            gameManager->getScoreSystem()->getHighScore());
+        printf("events: %llu spawned, %llu gems collected, %llu explosions\n",
+            stats.spawned, stats.collected, stats.explosions);
+        printf("audio: %llu sounds played, %llu triggers dropped\n",
+            gameManager->getVoicePool()->getTotalPlayed(), gameManager->getVoicePool()->getTotalDropped());
+        const BroadPhaseStats& collisions = gameManager->getBroadPhase()->getStats();
+        printf("collision: %llu candidates tested, %llu objects culled by the broad phase\n",
+            collisions.totalCandidates, collisions.totalRejected);
     }
-    delete soundObserver;
+    if (options.replayPath != nullptr) {
+        printf("replay: %llu ticks, seed %u, score %d, high score %d\n",
+            gameManager->getReplayPlayer()->getTickCount(), gameManager->getRandomSeed(),
+            gameManager->getScoreSystem()->getScore(),
+            gameManager->getScoreSystem()->getHighScore());
+    }
+    Leaderboard* leaderboard = gameManager->getLeaderboard();
+    if (leaderboard->isOpen()) {
+        printf("leaderboard: %llu runs, best %d\n", leaderboard->getTotalRuns(), leaderboard->getBestScore());
+    }
+    const LatencyStats& latency = gameManager->getFramePacer()->getLatency();
+    if (!options.headless && latency.getTotalSamples() > 0) {
+        printf("latency: %llu input changes, input-to-present p50 %.2f ms, p95 %.2f ms, p99 %.2f ms\n",
+            latency.getTotalSamples(), latency.percentile(0.5f), latency.percentile(0.95f),
+            latency.percentile(0.99f));
+    }
+#ifdef COLLECTDGEMS_PROFILER
+    if (options.tracePath != nullptr) {
+        Profiler::getInstance()->writeChromeTrace(options.tracePath);
+    }
+#endif
+
     gameManager->cleanup();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,207 @@
+// Bakes every asset listed in AssetIds.h into one pack file that the game
+// maps at startup (see AssetPack.h). Decoding happens here, once, instead of
+// on every launch.
+//
+//   collectdgems_packer <source dir> <output pack>
+//
+// The source dir is the one containing Resources/. Any missing asset, or one
+// whose name only matches the file on disk ignoring case, is an error, so a
+// bad path fails the build instead of failing silently on Linux.
+#include "raylib.h"
+#include "AssetIds.h"
+#include "AssetPack.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Blob {
+    std::vector<unsigned char> bytes;
+};
+
+void append(Blob& blob, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    blob.bytes.insert(blob.bytes.end(), bytes, bytes + size);
+}
+
+// Checks the exact spelling too: on Windows and macOS opening a mis-cased
+// name works, but the same path fails on Linux.
+bool checkFileName(const std::filesystem::path& path) {
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(path.parent_path(), error)) {
+        if (entry.path().filename() == path.filename()) {
+            return true;
+        }
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(path.parent_path(), error)) {
+        std::string onDisk = entry.path().filename().string();
+        std::string wanted = path.filename().string();
+        if (onDisk.size() == wanted.size() &&
+            std::equal(onDisk.begin(), onDisk.end(), wanted.begin(),
+                [](char a, char b) { return tolower((unsigned char)a) == tolower((unsigned char)b); })) {
+            fprintf(stderr, "packer: %s is named %s on disk\n", path.string().c_str(), onDisk.c_str());
+            return false;
+        }
+    }
+    fprintf(stderr, "packer: %s not found\n", path.string().c_str());
+    return false;
+}
+
+bool packImage(const char* path, PackEntry& entry, Blob& blob) {
+    Image image = LoadImage(path);
+    if (image.data == nullptr) {
+        fprintf(stderr, "packer: cannot decode %s\n", path);
+        return false;
+    }
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    entry.params[0] = (uint32_t)image.width;
+    entry.params[1] = (uint32_t)image.height;
+    entry.params[2] = (uint32_t)image.format;
+    append(blob, image.data, (size_t)GetPixelDataSize(image.width, image.height, image.format));
+    UnloadImage(image);
+    return true;
+}
+
+// Same size, charset and padding LoadFont() uses.
+bool packFont(const char* path, PackEntry& entry, Blob& blob) {
+    int dataSize = 0;
+    unsigned char* data = LoadFileData(path, &dataSize);
+    const int baseSize = 32;
+    const int glyphCount = 95;
+    const int glyphPadding = 4;
+    GlyphInfo* glyphs = data != nullptr ?
+        LoadFontData(data, dataSize, baseSize, nullptr, glyphCount, FONT_DEFAULT) : nullptr;
+    UnloadFileData(data);
+    if (glyphs == nullptr) {
+        fprintf(stderr, "packer: cannot rasterize %s\n", path);
+        return false;
+    }
+
+    Rectangle* recs = nullptr;
+    Image atlas = GenImageFontAtlas(glyphs, &recs, glyphCount, baseSize, glyphPadding, 0);
+    for (int i = 0; i < glyphCount; i++) {
+        PackGlyph glyph = {
+            glyphs[i].value, glyphs[i].offsetX, glyphs[i].offsetY, glyphs[i].advanceX,
+            recs[i].x, recs[i].y, recs[i].width, recs[i].height
+        };
+        append(blob, &glyph, sizeof(glyph));
+    }
+    append(blob, atlas.data, (size_t)GetPixelDataSize(atlas.width, atlas.height, atlas.format));
+
+    entry.params[0] = baseSize;
+    entry.params[1] = glyphCount;
+    entry.params[2] = glyphPadding;
+    entry.params[3] = (uint32_t)atlas.width;
+    entry.params[4] = (uint32_t)atlas.height;
+    entry.params[5] = (uint32_t)atlas.format;
+
+    UnloadImage(atlas);
+    UnloadFontData(glyphs, glyphCount);
+    MemFree(recs);
+    return true;
+}
+
+bool packSound(const char* path, PackEntry& entry, Blob& blob) {
+    Wave wave = LoadWave(path);
+    if (wave.data == nullptr || wave.frameCount == 0) {
+        fprintf(stderr, "packer: cannot decode %s\n", path);
+        return false;
+    }
+    entry.params[0] = wave.frameCount;
+    entry.params[1] = wave.sampleRate;
+    entry.params[2] = wave.sampleSize;
+    entry.params[3] = wave.channels;
+    append(blob, wave.data, (size_t)wave.frameCount * wave.channels * (wave.sampleSize / 8));
+    UnloadWave(wave);
+    return true;
+}
+
+bool packRaw(const char* path, Blob& blob) {
+    int dataSize = 0;
+    unsigned char* data = LoadFileData(path, &dataSize);
+    if (data == nullptr || dataSize == 0) {
+        fprintf(stderr, "packer: cannot read %s\n", path);
+        return false;
+    }
+    append(blob, data, (size_t)dataSize);
+    UnloadFileData(data);
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <source dir> <output pack>\n", argv[0]);
+        return 2;
+    }
+    SetTraceLogLevel(LOG_WARNING);
+    std::filesystem::path sourceDir = argv[1];
+
+    PackEntry entries[ASSET_COUNT];
+    Blob blobs[ASSET_COUNT];
+    bool ok = true;
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        const AssetInfo& info = ASSET_INFO[i];
+        std::filesystem::path path = sourceDir / info.fileName;
+        memset(&entries[i], 0, sizeof(PackEntry));
+        entries[i].kind = (uint32_t)info.kind;
+        if (!checkFileName(path)) {
+            ok = false;
+            continue;
+        }
+
+        std::string file = path.string();
+        switch (info.kind) {
+        case AssetKind::IMAGE: ok = packImage(file.c_str(), entries[i], blobs[i]) && ok; break;
+        case AssetKind::FONT: ok = packFont(file.c_str(), entries[i], blobs[i]) && ok; break;
+        case AssetKind::SOUND: ok = packSound(file.c_str(), entries[i], blobs[i]) && ok; break;
+        case AssetKind::MUSIC: ok = packRaw(file.c_str(), blobs[i]) && ok; break;
+        }
+    }
+    if (!ok) {
+        return 1;
+    }
+
+    uint64_t offset = sizeof(PackHeader) + sizeof(entries);
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        offset = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+        entries[i].offset = offset;
+        entries[i].size = blobs[i].bytes.size();
+        offset += entries[i].size;
+    }
+
+    FILE* out = fopen(argv[2], "wb");
+    if (out == nullptr) {
+        fprintf(stderr, "packer: cannot write %s\n", argv[2]);
+        return 1;
+    }
+    PackHeader header = {};
+    memcpy(header.magic, AssetPack::MAGIC, 4);
+    header.version = AssetPack::VERSION;
+    header.entryCount = ASSET_COUNT;
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(entries, sizeof(entries), 1, out);
+
+    const unsigned char padding[PACK_ALIGNMENT] = {};
+    uint64_t written = sizeof(PackHeader) + sizeof(entries);
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        fwrite(padding, 1, (size_t)(entries[i].offset - written), out);
+        fwrite(blobs[i].bytes.data(), 1, blobs[i].bytes.size(), out);
+        written = entries[i].offset + entries[i].size;
+        printf("packed %-26s %9llu bytes\n", ASSET_INFO[i].fileName, (unsigned long long)entries[i].size);
+    }
+    bool writeOk = ferror(out) == 0;
+    writeOk = fclose(out) == 0 && writeOk;
+    if (!writeOk) {
+        fprintf(stderr, "packer: error writing %s\n", argv[2]);
+        remove(argv[2]);
+        return 1;
+    }
+    return 0;
+}